@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include <benchmark/benchmark.h>
+#include <boost/program_options.hpp>
+#include <boost/lexical_cast.hpp>
+#include <Eigen/Geometry>
+#include <sstream>
+
+#include "transform_parser.h"
+
+typedef std::vector<geometry_msgs::TransformStamped> Transforms;
+
+// reference: previous boost::program_options / boost::lexical_cast based parsing
+namespace reference {
+namespace po = boost::program_options;
+typedef std::vector<std::string> Tuple;
+
+static double parse_double(const std::string &s) {
+  try {
+    return boost::lexical_cast<double>(s);
+  } catch (const boost::bad_lexical_cast &e) {
+    throw po::error("failed to parse numerical value: " + s);
+  }
+}
+
+static void parse_transform(const Tuple &args, std::string mode,
+                            geometry_msgs::TransformStamped &msg) {
+  Tuple::const_iterator arg = args.begin();
+  const size_t numArgs = 3 + 2;
+  if (args.size() < numArgs+3)
+    throw po::error("invalid number of positional arguments");
+
+  bool bQuatMode = (mode == "wxyz" || mode == "xyzw");
+  if (mode == "") {
+    if (args.size() == numArgs+4) {
+      bQuatMode = true;
+      mode = "xyzw";
+    } else if (args.size() == numArgs+3) {
+      mode = "zyx";
+    } else {
+      throw po::error("invalid number of positional arguments");
+    }
+  }
+
+  msg.transform.translation.x = parse_double(*arg); ++arg;
+  msg.transform.translation.y = parse_double(*arg); ++arg;
+  msg.transform.translation.z = parse_double(*arg); ++arg;
+
+  Eigen::Quaterniond q;
+  if (bQuatMode) {
+    if (args.size() != numArgs+4)
+      throw po::error("quaternion mode requires " +
+                      boost::lexical_cast<std::string>(numArgs+4) + " positional arguments");
+    const std::string eigen_order("xyzw");
+    double data[4];
+    for (size_t i=0; i<4; ++i) {
+      size_t idx = eigen_order.find(mode[i]);
+      data[idx] = parse_double(*arg); ++arg;
+    }
+    q = Eigen::Quaterniond(data);
+  } else {
+    if (args.size() != numArgs+3)
+      throw po::error("Euler angles require " +
+                      boost::lexical_cast<std::string>(numArgs+3) + " positional arguments");
+    const std::string axes_order("xyz");
+    size_t axes_idxs[3];
+    double angles[3];
+    for (size_t i=0; i<3; ++i) {
+      size_t idx = axes_order.find(mode[i]);
+      if (idx == std::string::npos)
+        throw po::error("invalid axis specification for Euler angles: " +
+                        boost::lexical_cast<std::string>(mode[i]));
+      axes_idxs[i] = idx;
+      angles[i] = parse_double(*arg); ++arg;
+    }
+    q = Eigen::AngleAxisd(angles[0], Eigen::Vector3d::Unit(axes_idxs[0])) *
+        Eigen::AngleAxisd(angles[1], Eigen::Vector3d::Unit(axes_idxs[1])) *
+        Eigen::AngleAxisd(angles[2], Eigen::Vector3d::Unit(axes_idxs[2]));
+  }
+  q.normalize();
+  msg.transform.rotation.x = q.x();
+  msg.transform.rotation.y = q.y();
+  msg.transform.rotation.z = q.z();
+  msg.transform.rotation.w = q.w();
+
+  msg.header.frame_id = *arg++;
+  msg.child_frame_id = *arg++;
+}
+
+static void parse_arguments(int argc, char **argv, Transforms &transforms) {
+  std::string mode, filename;
+  po::options_description options_description("allowed options");
+  options_description.add_options()
+      ("help,h", "show this help message")
+      ("mode,m", po::value<std::string>(&mode))
+      ("file,f", po::value<std::string>(&filename), "read transforms from file")
+      ;
+  po::variables_map variables_map;
+  po::parsed_options parsed =
+      po::command_line_parser(argc, argv).options(options_description).allow_unregistered().run();
+  po::store(parsed, variables_map);
+  po::notify(variables_map);
+  Tuple args = po::collect_unrecognized(parsed.options, po::include_positional);
+
+  std::vector<Tuple> tuples(1);
+  for (Tuple::const_iterator it = args.begin(), end = args.end(); it != end; ++it) {
+    if (*it == ",") tuples.push_back(Tuple());
+    else tuples.back().push_back(*it);
+  }
+  for (size_t i=0; i < tuples.size(); ++i) {
+    geometry_msgs::TransformStamped msg;
+    parse_transform(tuples[i], mode, msg);
+    transforms.push_back(msg);
+  }
+}
+}
+
+/// command line with N transforms, either given as Euler angles (0) or quaternions (1)
+static std::vector<std::string> arguments(int n, bool quaternion)
+{
+  std::vector<std::string> args(1, "static_transform_publisher");
+  for (int i = 0; i < n; ++i) {
+    if (i > 0) args.push_back(",");
+    const char *position[] = {"0.1", "-0.25", "1.5"};
+    args.insert(args.end(), position, position + 3);
+    if (quaternion) {
+      const char *rotation[] = {"0", "0", "0.7071068", "0.7071068"};
+      args.insert(args.end(), rotation, rotation + 4);
+    } else {
+      const char *rotation[] = {"1.5707963", "0", "-0.5"};
+      args.insert(args.end(), rotation, rotation + 3);
+    }
+    std::ostringstream child;
+    child << "frame_" << i;
+    args.push_back("world");
+    args.push_back(child.str());
+  }
+  return args;
+}
+
+static std::vector<char*> argv(std::vector<std::string> &args)
+{
+  std::vector<char*> result;
+  for (size_t i = 0; i < args.size(); ++i)
+    result.push_back(&args[i][0]);
+  return result;
+}
+
+static void BM_ReferenceParseArguments(benchmark::State &state)
+{
+  std::vector<std::string> args = arguments(state.range(0), state.range(1));
+  std::vector<char*> av = argv(args);
+  for (auto _ : state) {
+    Transforms transforms;
+    reference::parse_arguments(av.size(), av.data(), transforms);
+    benchmark::DoNotOptimize(transforms.data());
+  }
+}
+BENCHMARK(BM_ReferenceParseArguments)->ArgsProduct({{1, 10, 100}, {0, 1}});
+
+static void BM_ParseArguments(benchmark::State &state)
+{
+  std::vector<std::string> args = arguments(state.range(0), state.range(1));
+  std::vector<char*> av = argv(args);
+  const RotationMode mode = parse_mode("");
+  for (auto _ : state) {
+    Tuple positional;
+    for (size_t i = 1; i < av.size(); ++i)
+      positional.push_back(Token(av[i]));
+    std::vector<Tuple> tuples;
+    split_tuples(positional, tuples);
+
+    Transforms transforms(tuples.size());
+    for (size_t i = 0; i < tuples.size(); ++i)
+      parse_transform(tuples[i], mode, transforms[i]);
+    benchmark::DoNotOptimize(transforms.data());
+  }
+}
+BENCHMARK(BM_ParseArguments)->ArgsProduct({{1, 10, 100}, {0, 1}});
+
+BENCHMARK_MAIN();
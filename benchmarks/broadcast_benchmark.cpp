@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include <benchmark/benchmark.h>
+#include <ros/ros.h>
+#include <tf2_msgs/TFMessage.h>
+#include <QCoreApplication>
+#include <sstream>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "TransformBroadcaster.h"
+
+/// in-process subscriber to /tf_static, collecting statistics
+struct TfStaticListener
+{
+  TfStaticListener() : messages(0), transforms(0) {
+    sub = ros::NodeHandle().subscribe("/tf_static", 1000, &TfStaticListener::callback, this);
+  }
+  void callback(const tf2_msgs::TFMessageConstPtr &msg) {
+    ++messages;
+    transforms = msg->transforms.size();
+    if (!msg->transforms.empty()) last_child = msg->transforms.back().child_frame_id;
+  }
+  /// spin until condition holds or timeout expired
+  template <typename Condition>
+  bool waitFor(Condition condition, double timeout = 10.0) {
+    const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(timeout);
+    while (!condition(*this)) {
+      if (ros::WallTime::now() > end) return false;
+      // deferred publishing: broadcaster and registry flush from (chained) zero-timers
+      QCoreApplication::processEvents();
+      ros::getGlobalCallbackQueue()->callAvailable(ros::WallDuration(0.001));
+    }
+    return true;
+  }
+
+  ros::Subscriber sub;
+  size_t messages;
+  size_t transforms;
+  std::string last_child;
+};
+
+// TransformBroadcaster::send() throughput, without (0) and with (1) coalescing
+static void BM_TransformBroadcasterSend(benchmark::State &state)
+{
+  if (!ros::master::check()) {
+    state.SkipWithError("ROS master not available");
+    return;
+  }
+  TfStaticListener listener;
+  TransformBroadcaster tf_pub("world", "bench_frame");
+  tf_pub.setCoalescing(state.range(0) != 0);
+  QCoreApplication::processEvents();
+  if (!listener.waitFor([](const TfStaticListener &l) { return l.messages > 0; })) {
+    state.SkipWithError("failed to connect to /tf_static");
+    return;
+  }
+
+  const size_t start = listener.messages;
+  double x = 0;
+  for (auto _ : state) {
+    tf_pub.setPosition(x += 1e-3, 0, 0);
+    tf_pub.setQuaternion(0, 0, 0, 1);
+    QCoreApplication::processEvents();
+  }
+  const size_t sent = state.iterations();
+  listener.waitFor([start, sent](const TfStaticListener &l) { return l.messages - start >= sent; }, 1.0);
+  state.counters["received"] = benchmark::Counter(listener.messages - start, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TransformBroadcasterSend)->Arg(0)->Arg(1)->UseRealTime();
+
+// time from starting static_transform_publisher with N transforms until its message arrives
+static void BM_StaticTransformPublisherStartup(benchmark::State &state)
+{
+  if (!ros::master::check()) {
+    state.SkipWithError("ROS master not available");
+    return;
+  }
+  const int n = state.range(0);
+  TfStaticListener listener;
+  int run = 0;
+
+  for (auto _ : state) {
+    // unique child frames per run to identify the expected message
+    std::ostringstream prefix;
+    prefix << "bench_" << getpid() << "_" << run++ << "_";
+    std::vector<std::string> args(1, STATIC_TRANSFORM_PUBLISHER);
+    for (int i = 0; i < n; ++i) {
+      if (i > 0) args.push_back(",");
+      const char *tuple[] = {"0", "0", "1", "0", "0", "0", "world"};
+      args.insert(args.end(), tuple, tuple + 7);
+      std::ostringstream child;
+      child << prefix.str() << i;
+      args.push_back(child.str());
+    }
+    const std::string expected = args.back();
+    std::vector<char*> argv;
+    for (size_t i = 0; i < args.size(); ++i)
+      argv.push_back(const_cast<char*>(args[i].c_str()));
+    argv.push_back(NULL);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      execv(argv[0], argv.data());
+      _exit(EXIT_FAILURE);
+    }
+    bool received = listener.waitFor([&expected](const TfStaticListener &l) {
+      return l.last_child == expected;
+    });
+
+    state.PauseTiming();
+    kill(pid, SIGINT);
+    waitpid(pid, NULL, 0);
+    state.ResumeTiming();
+
+    if (!received) {
+      state.SkipWithError("static_transform_publisher did not publish in time");
+      break;
+    }
+  }
+}
+BENCHMARK(BM_StaticTransformPublisherStartup)->Arg(1)->Arg(10)->Arg(100)
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char **argv)
+{
+  benchmark::Initialize(&argc, argv);
+  ros::init(argc, argv, "broadcast_benchmark", ros::init_options::AnonymousName);
+  QCoreApplication app(argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "EulerConversion.h"
+#include "BulkConversion.h"
+#include "euler_property.h"
+
+// all 12 rotating-frame axis triples
+static const unsigned int AXES[12][3] = {
+  {0,1,0}, {0,1,2}, {0,2,0}, {0,2,1},
+  {1,0,1}, {1,0,2}, {1,2,0}, {1,2,1},
+  {2,0,1}, {2,0,2}, {2,1,0}, {2,1,2}
+};
+static const char *AXES_SPECS[] = {
+  "xyx", "xyz", "xzx", "xzy", "yxy", "yxz", "yzx", "yzy", "zxy", "zxz", "zyx", "zyz",
+  "sxyz", "rzyx", "rpy", "ypr"
+};
+
+static std::vector<Eigen::Quaterniond> randomQuaternions(size_t n)
+{
+  std::srand(42);
+  std::vector<Eigen::Quaterniond> result(n);
+  for (size_t i = 0; i < n; ++i)
+    result[i] = Eigen::Quaterniond::UnitRandom();
+  return result;
+}
+
+// reference: Eigen's generic decomposition of the full rotation matrix
+static void BM_EigenEulerAngles(benchmark::State &state)
+{
+  const unsigned int *a = AXES[state.range(0)];
+  const std::vector<Eigen::Quaterniond> qs = randomQuaternions(1024);
+  size_t i = 0;
+  for (auto _ : state) {
+    Eigen::Vector3d e = qs[i++ % qs.size()].matrix().eulerAngles(a[0], a[1], a[2]);
+    benchmark::DoNotOptimize(e);
+  }
+}
+BENCHMARK(BM_EigenEulerAngles)->DenseRange(0, 11);
+
+static void BM_EulerAngles(benchmark::State &state)
+{
+  const unsigned int *a = AXES[state.range(0)];
+  const std::vector<Eigen::Quaterniond> qs = randomQuaternions(1024);
+  size_t i = 0;
+  for (auto _ : state) {
+    Eigen::Vector3d e = euler::eulerAngles(qs[i++ % qs.size()], a);
+    benchmark::DoNotOptimize(e);
+  }
+}
+BENCHMARK(BM_EulerAngles)->DenseRange(0, 11);
+
+static void BM_EulerAnglesBatch(benchmark::State &state)
+{
+  const std::vector<Eigen::Quaterniond> qs = randomQuaternions(state.range(0));
+  std::vector<Eigen::Vector3d> es(qs.size());
+  for (auto _ : state) {
+    euler::eulerAngles(qs.data(), es.data(), qs.size(), AXES[1]);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * qs.size());
+}
+BENCHMARK(BM_EulerAnglesBatch)->Range(8, 1 << 16);
+
+// structure-of-arrays bulk conversion of 10^6 rows, round trip Euler -> quaternion -> Euler
+static void BM_BulkConversion(benchmark::State &state)
+{
+  const size_t n = 1000000;
+  const unsigned int threads = state.range(0);
+  std::vector<double> e[3], q[4];
+  for (int k = 0; k < 3; ++k) e[k].assign(n, 0.1 * (k + 1));
+  for (int k = 0; k < 4; ++k) q[k].resize(n);
+  double *const e_ptr[3] = { e[0].data(), e[1].data(), e[2].data() };
+  double *const q_ptr[4] = { q[0].data(), q[1].data(), q[2].data(), q[3].data() };
+  euler::Convention convention;
+  convention.parse("rpy");
+  for (auto _ : state) {
+    euler::quaternions(convention, e_ptr, q_ptr, n, threads);
+    euler::eulerAngles(convention, q_ptr, e_ptr, n, threads);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_BulkConversion)->Arg(1)->Arg(2)->Arg(4)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_Quaternion(benchmark::State &state)
+{
+  const unsigned int *a = AXES[state.range(0)];
+  double e[3] = {0.1, 0.2, 0.3};
+  for (auto _ : state) {
+    Eigen::Quaterniond q = euler::quaternion(e, a);
+    benchmark::DoNotOptimize(q);
+    e[0] += 1e-6;
+  }
+}
+BENCHMARK(BM_Quaternion)->DenseRange(0, 11);
+
+static void BM_EulerPropertySetEulerAxes(benchmark::State &state)
+{
+  rviz::EulerProperty property;
+  const size_t n = sizeof(AXES_SPECS) / sizeof(AXES_SPECS[0]);
+  size_t i = 0;
+  for (auto _ : state)
+    property.setEulerAxes(AXES_SPECS[i++ % n]);
+}
+BENCHMARK(BM_EulerPropertySetEulerAxes);
+
+static void BM_EulerPropertySetValue(benchmark::State &state)
+{
+  rviz::EulerProperty property;
+  const QVariant values[] = {
+    QString("rpy: 10; 20; 30"), QString("xyz: 30; 20; 10"), QString("45"), QString("szyx: 1.5; -2.5; 3")
+  };
+  size_t i = 0;
+  for (auto _ : state)
+    property.setValue(values[i++ % 4]);
+}
+BENCHMARK(BM_EulerPropertySetValue);
+
+static void BM_EulerPropertySetQuaternion(benchmark::State &state)
+{
+  rviz::EulerProperty property;
+  const std::vector<Eigen::Quaterniond> qs = randomQuaternions(1024);
+  size_t i = 0;
+  for (auto _ : state)
+    property.setQuaternion(qs[i++ % qs.size()]);
+}
+BENCHMARK(BM_EulerPropertySetQuaternion);
+
+BENCHMARK_MAIN();
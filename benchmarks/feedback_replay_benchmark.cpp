@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+
+/* Replay interactive-marker feedback into a headless TransformPublisherDisplay
+ *
+ * Feedback sequences are injected into onMarkerFeedback() at a fixed rate,
+ * processing Qt events (coalescing timers, registry flush) and calling update()
+ * at 60 Hz in between, like rviz would. Reported per run:
+ * - end-to-end latency from injecting a pose until it arrives on /tf_static or /tf
+ * - process CPU time per injected event
+ * - number of messages received
+ *
+ * By default, a deterministic drag sequence is generated. A recorded sequence
+ * can be replayed from a bag file with --feedback-bag=<file> [--feedback-topic=<topic>].
+ *
+ * BM_DisplayStartup measures creating and loading many (enabled or disabled) displays,
+ * as rviz does when opening a large config, and reports whether /tf_static got advertised.
+ * Requires a running ROS master.
+ */
+
+#include <benchmark/benchmark.h>
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <tf2_msgs/TFMessage.h>
+#include <visualization_msgs/InteractiveMarkerFeedback.h>
+#include <rviz/display_context.h>
+#include <rviz/frame_manager.h>
+#include <rviz/config.h>
+#include <OGRE/OgreRoot.h>
+#include <OGRE/OgreSceneManager.h>
+#include <QApplication>
+#include <boost/thread/mutex.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <map>
+#include <string>
+
+#ifdef HAVE_ROSBAG
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#endif
+
+#include "TransformPublisherDisplay.h"
+#include "Statistics.h"
+
+namespace vm = visualization_msgs;
+
+static const std::string PARENT_FRAME = "world";
+static const std::string CHILD_FRAME = "replay_frame";
+static std::string g_feedback_bag;
+static std::string g_feedback_topic = "/rviz_feedback";
+
+/// minimal DisplayContext running a display without rendering: only tf is functional
+class HeadlessContext : public rviz::DisplayContext
+{
+public:
+  HeadlessContext() : root_("", "", ""), frame_count_(0) {
+    scene_manager_ = root_.createSceneManager(Ogre::ST_GENERIC);
+    frame_manager_ = new rviz::FrameManager();
+    frame_manager_->setFixedFrame(PARENT_FRAME);
+  }
+  ~HeadlessContext() {
+    delete frame_manager_;
+    root_.destroySceneManager(scene_manager_);
+  }
+
+  Ogre::SceneManager* getSceneManager() const { return scene_manager_; }
+  rviz::WindowManagerInterface* getWindowManager() const { return 0; }
+  rviz::SelectionManager* getSelectionManager() const { return 0; }
+  rviz::FrameManager* getFrameManager() const { return frame_manager_; }
+  QString getFixedFrame() const { return QString::fromStdString(PARENT_FRAME); }
+  uint64_t getFrameCount() const { return frame_count_; }
+  rviz::DisplayFactory* getDisplayFactory() const { return 0; }
+  ros::CallbackQueueInterface* getUpdateQueue() { return ros::getGlobalCallbackQueue(); }
+  ros::CallbackQueueInterface* getThreadedQueue() { return &threaded_queue_; }
+  void handleChar(QKeyEvent*, rviz::RenderPanel*) {}
+  void handleMouseEvent(const rviz::ViewportMouseEvent&) {}
+  rviz::ToolManager* getToolManager() const { return 0; }
+  rviz::ViewManager* getViewManager() const { return 0; }
+  rviz::DisplayGroup* getRootDisplayGroup() const { return 0; }
+  uint32_t getDefaultVisibilityBit() const { return 1; }
+  rviz::BitAllocator* visibilityBits() { return 0; }
+  void setStatus(const QString&) {}
+  void queueRender() {}
+
+  /// emulate one render cycle
+  void update(rviz::Display &display, float dt) {
+    ++frame_count_;
+    frame_manager_->update();
+    ros::getGlobalCallbackQueue()->callAvailable();
+    display.update(dt, dt);
+  }
+
+private:
+  Ogre::Root root_;
+  Ogre::SceneManager *scene_manager_;
+  rviz::FrameManager *frame_manager_;
+  ros::CallbackQueue threaded_queue_;
+  uint64_t frame_count_;
+};
+
+/// expose protected API of TransformPublisherDisplay to the harness
+class ReplayDisplay : public agni_tf_tools::TransformPublisherDisplay
+{
+public:
+  using TransformPublisherDisplay::onMarkerFeedback;
+};
+
+/// pose key as seen by the display: translation is stored with float precision
+typedef boost::tuple<float, float, float> PoseKey;
+static PoseKey poseKey(const geometry_msgs::Point &p) { return PoseKey(p.x, p.y, p.z); }
+static PoseKey poseKey(const geometry_msgs::Vector3 &p) { return PoseKey(p.x, p.y, p.z); }
+
+/// records arrival times of CHILD_FRAME poses on /tf_static and /tf in a separate thread
+class ArrivalRecorder
+{
+public:
+  ArrivalRecorder() : messages_(0), spinner_(1, &queue_) {
+    ros::NodeHandle nh;
+    nh.setCallbackQueue(&queue_);
+    static_sub_ = nh.subscribe("/tf_static", 1000, &ArrivalRecorder::callback, this);
+    dynamic_sub_ = nh.subscribe("/tf", 1000, &ArrivalRecorder::callback, this);
+    spinner_.start();
+  }
+  ~ArrivalRecorder() { spinner_.stop(); }
+
+  void callback(const tf2_msgs::TFMessageConstPtr &msg) {
+    const ros::WallTime now = ros::WallTime::now();
+    for (size_t i = 0; i < msg->transforms.size(); ++i) {
+      if (msg->transforms[i].child_frame_id != CHILD_FRAME) continue;
+      boost::mutex::scoped_lock lock(mutex_);
+      ++messages_;
+      arrivals_.push_back(std::make_pair(now, poseKey(msg->transforms[i].transform.translation)));
+    }
+  }
+  void reset() {
+    boost::mutex::scoped_lock lock(mutex_);
+    messages_ = 0;
+    arrivals_.clear();
+  }
+  /// wait until given pose arrived or timeout expired
+  bool waitFor(const PoseKey &key, double timeout) {
+    const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(timeout);
+    while (ros::WallTime::now() < end) {
+      QCoreApplication::processEvents();
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        if (!arrivals_.empty() && arrivals_.back().second == key) return true;
+      }
+      ros::WallDuration(0.001).sleep();
+    }
+    return false;
+  }
+  size_t messages() {
+    boost::mutex::scoped_lock lock(mutex_);
+    return messages_;
+  }
+  /// add latencies of all arrivals w.r.t. their (first) injection time
+  void latencies(const std::map<PoseKey, ros::WallTime> &injected, LatencyHistogram &h) {
+    boost::mutex::scoped_lock lock(mutex_);
+    for (size_t i = 0; i < arrivals_.size(); ++i) {
+      std::map<PoseKey, ros::WallTime>::const_iterator it = injected.find(arrivals_[i].second);
+      if (it != injected.end()) h.add((arrivals_[i].first - it->second).toSec());
+    }
+  }
+
+private:
+  boost::mutex mutex_;
+  size_t messages_;
+  std::vector<std::pair<ros::WallTime, PoseKey> > arrivals_;
+  ros::CallbackQueue queue_;
+  ros::AsyncSpinner spinner_;
+  ros::Subscriber static_sub_, dynamic_sub_;
+};
+
+/// saved config of a display publishing child frame w.r.t. PARENT_FRAME
+static rviz::Config displayConfig(const std::string &child, const QString &marker, bool dynamic)
+{
+  rviz::Config config;
+  config.mapSetValue("parent frame", QString::fromStdString(PARENT_FRAME));
+  config.mapSetValue("marker type", marker);
+  rviz::Config publish = config.mapMakeChild("publish transform");
+  publish.mapSetValue("Value", true);
+  publish.mapSetValue("child frame", QString::fromStdString(child));
+  publish.mapMakeChild("dynamic while dragging").mapSetValue("Value", dynamic);
+  return config;
+}
+
+/// wait until topic is advertised by this node: the registry advertises from its publisher thread
+static bool advertised(const std::string &topic, double timeout)
+{
+  const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(timeout);
+  while (true) {
+    ros::V_string topics;
+    ros::this_node::getAdvertisedTopics(topics);
+    if (std::find(topics.begin(), topics.end(), topic) != topics.end()) return true;
+    if (ros::WallTime::now() >= end) return false;
+    QCoreApplication::processEvents();
+    ros::WallDuration(0.001).sleep();
+  }
+}
+
+/// deterministic drag: MOUSE_DOWN, n distinct POSE_UPDATEs along a helix, MOUSE_UP
+static std::vector<vm::InteractiveMarkerFeedback> dragSequence(size_t n)
+{
+  std::vector<vm::InteractiveMarkerFeedback> result(n + 2);
+  for (size_t k = 0; k < result.size(); ++k) {
+    vm::InteractiveMarkerFeedback &fb = result[k];
+    fb.header.frame_id = PARENT_FRAME;
+    fb.marker_name = "marker";
+    fb.control_name = "frame";
+    fb.event_type = vm::InteractiveMarkerFeedback::POSE_UPDATE;
+    const double t = std::min<double>(std::max<double>(k, 1), n) * 1e-3;
+    fb.pose.position.x = t;
+    fb.pose.position.y = std::sin(t);
+    fb.pose.position.z = std::cos(t);
+    fb.pose.orientation.z = std::sin(t / 2);
+    fb.pose.orientation.w = std::cos(t / 2);
+  }
+  result.front().event_type = vm::InteractiveMarkerFeedback::MOUSE_DOWN;
+  result.back().event_type = vm::InteractiveMarkerFeedback::MOUSE_UP;
+  return result;
+}
+
+/// recorded feedback, re-targeted to PARENT_FRAME (frame-locked marker)
+static std::vector<vm::InteractiveMarkerFeedback> recordedSequence(std::string *error)
+{
+  std::vector<vm::InteractiveMarkerFeedback> result;
+#ifdef HAVE_ROSBAG
+  try {
+    rosbag::Bag bag(g_feedback_bag);
+    rosbag::View view(bag, rosbag::TopicQuery(g_feedback_topic));
+    for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it) {
+      vm::InteractiveMarkerFeedbackConstPtr fb = it->instantiate<vm::InteractiveMarkerFeedback>();
+      if (!fb) continue;
+      result.push_back(*fb);
+      result.back().header.frame_id = PARENT_FRAME;
+    }
+  } catch (const rosbag::BagException &e) {
+    *error = e.what();
+  }
+  if (result.empty() && error->empty())
+    *error = "no feedback messages on " + g_feedback_topic;
+#else
+  *error = "built without rosbag support";
+#endif
+  return result;
+}
+
+static double processCpuTime()
+{
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// replay feedback at given rate (Hz), with static (0) or dynamic (1) publishing while dragging
+static void BM_ReplayMarkerFeedback(benchmark::State &state)
+{
+  if (!ros::master::check()) {
+    state.SkipWithError("ROS master not available");
+    return;
+  }
+  std::string error;
+  const std::vector<vm::InteractiveMarkerFeedback> events =
+      g_feedback_bag.empty() ? dragSequence(1000) : recordedSequence(&error);
+  if (events.empty()) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  const double period = 1.0 / state.range(0);
+  const double update_period = 1.0 / 60;
+
+  HeadlessContext context;
+  ReplayDisplay display;
+  display.initialize(&context);
+  display.load(displayConfig(CHILD_FRAME, "none", state.range(1) != 0));
+  display.setEnabled(true);
+
+  ArrivalRecorder recorder;
+  ros::WallDuration(0.5).sleep(); // connect subscribers
+  LatencyHistogram latency;
+  double cpu = 0;
+  size_t messages = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    recorder.reset();
+    // move away from the sequence's poses, so that the first event is not considered a duplicate
+    vm::InteractiveMarkerFeedback reset = events.front();
+    reset.event_type = vm::InteractiveMarkerFeedback::POSE_UPDATE;
+    reset.pose.position.x = -1;
+    display.onMarkerFeedback(reset);
+    QCoreApplication::processEvents();
+    recorder.waitFor(poseKey(reset.pose.position), 1.0);
+    recorder.reset();
+    state.ResumeTiming();
+
+    std::map<PoseKey, ros::WallTime> injected;
+    const double cpu_start = processCpuTime();
+    const ros::WallTime start = ros::WallTime::now();
+    ros::WallTime next_update = start;
+    for (size_t k = 0; k < events.size(); ++k) {
+      const ros::WallTime scheduled = start + ros::WallDuration(k * period);
+      const ros::WallDuration remaining = scheduled - ros::WallTime::now();
+      if (remaining > ros::WallDuration(0)) remaining.sleep();
+
+      const ros::WallTime now = ros::WallTime::now();
+      if (now >= next_update) {
+        context.update(display, update_period);
+        next_update = now + ros::WallDuration(update_period);
+      }
+      vm::InteractiveMarkerFeedback fb = events[k];
+      if (fb.event_type == vm::InteractiveMarkerFeedback::POSE_UPDATE)
+        injected.insert(std::make_pair(poseKey(fb.pose.position), ros::WallTime::now()));
+      display.onMarkerFeedback(fb);
+      QCoreApplication::processEvents();
+    }
+    for (int i = 0; i < 2; ++i) // flush deferred work
+      context.update(display, update_period);
+    if (!recorder.waitFor(poseKey(events.back().pose.position), 2.0)) {
+      state.SkipWithError("final pose was not published");
+      break;
+    }
+    cpu += processCpuTime() - cpu_start;
+    messages += recorder.messages();
+    recorder.latencies(injected, latency);
+  }
+
+  const double runs = state.iterations();
+  state.counters["events"] = events.size();
+  state.counters["messages"] = messages / runs;
+  state.counters["cpu/event [us]"] = 1e6 * cpu / (runs * events.size());
+  state.counters["latency mean [us]"] = 1e6 * latency.mean();
+  state.counters["latency p99 [us]"] = 1e6 * latency.percentile(0.99);
+  state.counters["latency max [us]"] = 1e6 * latency.max();
+}
+BENCHMARK(BM_ReplayMarkerFeedback)
+  ->ArgNames({"rate", "dynamic"})
+  ->Args({100, 0})->Args({1000, 0})->Args({10000, 0})
+  ->Args({100, 1})->Args({1000, 1})->Args({10000, 1})
+  ->Unit(benchmark::kMillisecond)->UseRealTime()->Iterations(3);
+
+// create, initialize and load given number of displays, either enabled (1) or disabled (0)
+static void BM_DisplayStartup(benchmark::State &state)
+{
+  if (!ros::master::check()) {
+    state.SkipWithError("ROS master not available");
+    return;
+  }
+  const int count = state.range(0);
+  const bool enabled = state.range(1) != 0;
+  std::vector<rviz::Config> configs;
+  for (int i = 0; i < count; ++i)
+    configs.push_back(displayConfig("startup_frame_" + std::to_string(i), "interactive frame", false));
+
+  HeadlessContext context;
+  size_t advertisements = 0;
+  for (auto _ : state) {
+    std::vector<ReplayDisplay*> displays;
+    for (int i = 0; i < count; ++i) {
+      ReplayDisplay *display = new ReplayDisplay();
+      display->initialize(&context);
+      display->load(configs[i]);
+      display->setEnabled(enabled);
+      displays.push_back(display);
+    }
+    QCoreApplication::processEvents(); // registry flush
+
+    state.PauseTiming();
+    advertisements += advertised("/tf_static", 0.5);
+    for (size_t i = 0; i < displays.size(); ++i)
+      delete displays[i];
+    QCoreApplication::processEvents();
+    state.ResumeTiming();
+  }
+  state.counters["displays"] = count;
+  state.counters["advertised"] = static_cast<double>(advertisements) / state.iterations();
+  // inverted rate: elapsed time / (1e-6 * count * iterations)
+  state.counters["per display [us]"] = benchmark::Counter(
+        1e-6 * count, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_DisplayStartup)
+  ->ArgNames({"displays", "enabled"})
+  ->Args({1, 0})->Args({100, 0})->Args({1, 1})->Args({100, 1})
+  ->Unit(benchmark::kMillisecond)->UseRealTime()
+  ->Iterations(20); // waiting for (missing) advertisements takes up to 0.5 s per iteration
+
+static bool parseOption(const char *arg, const char *name, std::string &value)
+{
+  const size_t len = strlen(name);
+  if (strncmp(arg, name, len) != 0 || arg[len] != '=') return false;
+  value = arg + len + 1;
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  benchmark::Initialize(&argc, argv);
+  ros::init(argc, argv, "feedback_replay_benchmark", ros::init_options::AnonymousName);
+  for (int i = 1; i < argc; ++i) {
+    if (!parseOption(argv[i], "--feedback-bag", g_feedback_bag) &&
+        !parseOption(argv[i], "--feedback-topic", g_feedback_topic)) {
+      fprintf(stderr, "unknown argument: %s\n", argv[i]);
+      return EXIT_FAILURE;
+    }
+  }
+#if QT_VERSION >= 0x050000
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen"); // run headless
+#endif
+  QApplication app(argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
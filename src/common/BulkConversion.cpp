@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include "BulkConversion.h"
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+
+namespace euler
+{
+
+namespace
+{
+
+/// call task(begin, end) for chunks of [0, n) in parallel, the first chunk in the calling thread
+template <typename Task>
+void parallelFor(std::size_t n, unsigned int threads, const Task &task)
+{
+  if (threads == 0) threads = std::max(1u, boost::thread::hardware_concurrency());
+  const std::size_t chunks = std::min<std::size_t>(threads, (n + MIN_CHUNK_SIZE - 1) / MIN_CHUNK_SIZE);
+  if (chunks <= 1) {
+    task(0, n);
+    return;
+  }
+  const std::size_t chunk = (n + chunks - 1) / chunks;
+  boost::thread_group group;
+  for (std::size_t begin = chunk; begin < n; begin += chunk)
+    group.create_thread(boost::bind<void>(task, begin, std::min(n, begin + chunk)));
+  task(0, chunk);
+  group.join_all();
+}
+
+struct QuaternionsTask
+{
+  const Convention *convention;
+  const double *const *e;
+  double *const *q;
+  void operator()(std::size_t begin, std::size_t end) const { convention->quaternions(e, q, begin, end); }
+};
+
+struct EulerAnglesTask
+{
+  const Convention *convention;
+  const double *const *q;
+  double *const *e;
+  void operator()(std::size_t begin, std::size_t end) const { convention->eulerAngles(q, e, begin, end); }
+};
+
+struct TransformsTask
+{
+  const double *const *p;
+  const double *const *q;
+  const std::string *parent_frame;
+  const std::vector<std::string> *child_frames;
+  geometry_msgs::TransformStamped *out;
+
+  void operator()(std::size_t begin, std::size_t end) const
+  {
+    for (std::size_t i = begin; i < end; ++i) {
+      geometry_msgs::TransformStamped &msg = out[i];
+      if (msg.header.frame_id != *parent_frame) msg.header.frame_id = *parent_frame;
+      if (msg.child_frame_id != (*child_frames)[i]) msg.child_frame_id = (*child_frames)[i];
+      msg.transform.translation.x = p[0][i];
+      msg.transform.translation.y = p[1][i];
+      msg.transform.translation.z = p[2][i];
+      msg.transform.rotation.x = q[0][i];
+      msg.transform.rotation.y = q[1][i];
+      msg.transform.rotation.z = q[2][i];
+      msg.transform.rotation.w = q[3][i];
+    }
+  }
+};
+
+} // anonymous namespace
+
+void quaternions(const Convention &convention, const double *const e[3], double *const q[4],
+                 std::size_t n, unsigned int threads)
+{
+  const QuaternionsTask task = { &convention, e, q };
+  parallelFor(n, threads, task);
+}
+
+void eulerAngles(const Convention &convention, const double *const q[4], double *const e[3],
+                 std::size_t n, unsigned int threads)
+{
+  const EulerAnglesTask task = { &convention, q, e };
+  parallelFor(n, threads, task);
+}
+
+void toTransforms(const double *const p[3], const double *const q[4], std::size_t n,
+                  const std::string &parent_frame, const std::vector<std::string> &child_frames,
+                  std::vector<geometry_msgs::TransformStamped> &out, unsigned int threads)
+{
+  out.resize(n);
+  if (n == 0) return;
+  const TransformsTask task = { p, q, &parent_frame, &child_frames, &out[0] };
+  parallelFor(n, threads, task);
+}
+
+} // namespace euler
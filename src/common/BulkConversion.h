@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#pragma once
+
+#include <geometry_msgs/TransformStamped.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "EulerConversion.h"
+
+/** Parallel conversion of large structure-of-arrays pose tables
+ *
+ *  Each component is stored in a separate contiguous array, i.e. rotation
+ *  coefficient k of row i is found at q[k][i]. The rows are split into chunks,
+ *  converted on up to threads cores with the Convention's straight-line kernels.
+ *  threads = 0 selects the number of hardware threads.
+ */
+namespace euler
+{
+
+/// rows per thread below which splitting the work doesn't pay off
+const std::size_t MIN_CHUNK_SIZE = 4096;
+
+/** convert n Euler angle triples into unit quaternions
+ *  @param e arrays of first, second, and third Euler angle (radians)
+ *  @param q arrays of quaternion coefficients x, y, z, w
+ */
+void quaternions(const Convention &convention, const double *const e[3], double *const q[4],
+                 std::size_t n, unsigned int threads = 0);
+
+/// convert n unit quaternions into Euler angle triples, see quaternions()
+void eulerAngles(const Convention &convention, const double *const q[4], double *const e[3],
+                 std::size_t n, unsigned int threads = 0);
+
+/** fill transform messages from n positions p (x, y, z arrays) and quaternions q (see above)
+ *  Existing messages in out are reused, such that frame strings are only reassigned.
+ */
+void toTransforms(const double *const p[3], const double *const q[4], std::size_t n,
+                  const std::string &parent_frame, const std::vector<std::string> &child_frames,
+                  std::vector<geometry_msgs::TransformStamped> &out, unsigned int threads = 0);
+
+} // namespace euler
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include "ChunkedTransformPublisher.h"
+#include <boost/functional/hash.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+
+static std::size_t hashTransform(const geometry_msgs::TransformStamped &tf)
+{
+  std::size_t seed = boost::hash_value(tf.child_frame_id);
+  boost::hash_combine(seed, tf.header.frame_id);
+  boost::hash_combine(seed, tf.header.stamp.sec);
+  boost::hash_combine(seed, tf.header.stamp.nsec);
+  const geometry_msgs::Vector3 &t = tf.transform.translation;
+  const geometry_msgs::Quaternion &q = tf.transform.rotation;
+  boost::hash_combine(seed, t.x);
+  boost::hash_combine(seed, t.y);
+  boost::hash_combine(seed, t.z);
+  boost::hash_combine(seed, q.x);
+  boost::hash_combine(seed, q.y);
+  boost::hash_combine(seed, q.z);
+  boost::hash_combine(seed, q.w);
+  return seed;
+}
+
+ChunkedTransformPublisher::ChunkedTransformPublisher(const std::string &topic, unsigned int chunks) :
+  spinner_(1, &queue_), chunks_(std::max(1u, chunks)), hashes_(std::max(1u, chunks), 0)
+{
+  nh_.setCallbackQueue(&queue_);
+  pub_ = nh_.advertise<tf2_msgs::TFMessage>(topic, 100,
+                                            boost::bind(&ChunkedTransformPublisher::connect, this, _1),
+                                            ros::SubscriberStatusCallback(), ros::VoidConstPtr(),
+                                            false);
+  spinner_.start();
+}
+
+ChunkedTransformPublisher::~ChunkedTransformPublisher()
+{
+  spinner_.stop();
+  pub_.shutdown();
+}
+
+std::size_t ChunkedTransformPublisher::publish(const std::vector<geometry_msgs::TransformStamped> &transforms)
+{
+  const std::size_t n = hashes_.size();
+  std::vector<std::size_t> hashes(n, 0);
+  std::vector<tf2_msgs::TFMessagePtr> messages(n);
+  std::vector<std::size_t> assignment(transforms.size());
+  // content hash is independent of the order within a chunk
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    const std::size_t c = boost::hash_value(transforms[i].child_frame_id) % n;
+    assignment[i] = c;
+    hashes[c] += hashTransform(transforms[i]);
+  }
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    const std::size_t c = assignment[i];
+    if (hashes[c] == hashes_[c]) continue; // unchanged chunk
+    if (!messages[c]) messages[c].reset(new tf2_msgs::TFMessage());
+    messages[c]->transforms.push_back(transforms[i]);
+  }
+
+  std::size_t sent = 0;
+  boost::mutex::scoped_lock lock(mutex_);
+  for (std::size_t c = 0; c < n; ++c) {
+    if (hashes[c] == hashes_[c]) continue;
+    hashes_[c] = hashes[c];
+    if (!messages[c]) { // chunk became empty: nothing to send, nothing to replay
+      chunks_[c].reset();
+      continue;
+    }
+    chunks_[c] = messages[c];
+    pub_.publish(chunks_[c]);
+    ++sent;
+  }
+  return sent;
+}
+
+void ChunkedTransformPublisher::connect(const ros::SingleSubscriberPublisher &pub)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  for (std::size_t c = 0; c < chunks_.size(); ++c)
+    if (chunks_[c]) pub.publish(*chunks_[c]);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#pragma once
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <tf2_msgs/TFMessage.h>
+#include <boost/thread/mutex.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** Publish a large set of static transforms in stable, content-hashed chunks
+ *
+ *  Instead of re-latching the whole set on each change, transforms are assigned
+ *  to a fixed number of chunks by hashing their child frame. publish() only sends
+ *  chunks whose content hash changed, to all connected subscribers. The topic is
+ *  not latched: newly connecting subscribers individually receive all non-empty chunks.
+ *  tf listeners accumulate static transforms, so this is equivalent to a latched full set.
+ *
+ *  Connection callbacks are served by a dedicated spinner thread.
+ *  publish() must be called from a single thread.
+ */
+class ChunkedTransformPublisher
+{
+public:
+  ChunkedTransformPublisher(const std::string &topic, unsigned int chunks);
+  ~ChunkedTransformPublisher();
+
+  /// publish changed chunks of the given (complete) set, @return number of sent chunks
+  std::size_t publish(const std::vector<geometry_msgs::TransformStamped> &transforms);
+
+  unsigned int chunks() const { return hashes_.size(); }
+
+private:
+  ChunkedTransformPublisher(const ChunkedTransformPublisher&);
+  ChunkedTransformPublisher& operator=(const ChunkedTransformPublisher&);
+
+  /// send all chunks to a new subscriber
+  void connect(const ros::SingleSubscriberPublisher &pub);
+
+  ros::CallbackQueue queue_; // serves connect()
+  ros::NodeHandle nh_;
+  ros::Publisher pub_;
+  ros::AsyncSpinner spinner_;
+
+  boost::mutex mutex_; // guards chunks_ between publish() and connect()
+  std::vector<tf2_msgs::TFMessageConstPtr> chunks_; // last sent content per chunk
+  std::vector<std::size_t> hashes_; // content hash per chunk
+};
@@ -0,0 +1,428 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#pragma once
+
+#include <Eigen/Geometry>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+/** Closed-form conversions between quaternions and Euler angles.
+ *
+ *  Kernels are specialized at compile time for the axis triple A0,A1,A2 (0=x, 1=y, 2=z)
+ *  of rotating-frame Euler angles, i.e. q = R(A0, e0) * R(A1, e1) * R(A2, e2).
+ *  Static-frame angles correspond to the reversed axis triple and reversed angles.
+ *
+ *  quaternion -> Euler yields exactly the angle ranges of Eigen's eulerAngles(),
+ *  but only evaluates the required rotation matrix coefficients directly from the quaternion.
+ *  Euler -> quaternion exploits the sparsity of the elementary rotations.
+ */
+namespace euler
+{
+namespace detail
+{
+
+/// rotation matrix coefficient (R,C) of a unit quaternion
+template <int R, int C, typename Scalar>
+inline Scalar coeff(const Eigen::Quaternion<Scalar> &q)
+{
+  const Scalar x = q.x(), y = q.y(), z = q.z(), w = q.w();
+  if (R == C) {
+    const Scalar a = R == 0 ? y : x;
+    const Scalar b = R == 2 ? y : z;
+    return Scalar(1) - Scalar(2) * (a*a + b*b);
+  }
+  // off-diagonal: 2 * (v[R]*v[C] -+ w*v[K]), with K the remaining axis
+  const Scalar v[3] = {x, y, z};
+  const int K = 3 - R - C;
+  const Scalar sign = (C == (R+1) % 3) ? Scalar(-1) : Scalar(1);
+  return Scalar(2) * (v[R]*v[C] + sign * w*v[K]);
+}
+
+} // namespace detail
+
+/// Euler angles of rotating axes A0,A1,A2 (identical to q.matrix().eulerAngles(A0,A1,A2))
+template <int A0, int A1, int A2, typename Scalar>
+inline Eigen::Matrix<Scalar,3,1> eulerAngles(const Eigen::Quaternion<Scalar> &q)
+{
+  EIGEN_STATIC_ASSERT(A0 >= 0 && A0 < 3 && A1 >= 0 && A1 < 3 && A2 >= 0 && A2 < 3 &&
+                      A0 != A1 && A1 != A2, INVALID_EULER_AXES)
+  using detail::coeff;
+  const bool odd = (A0+1) % 3 != A1;
+  const int i = A0;
+  const int j = (A0 + 1 + odd) % 3;
+  const int k = (A0 + 2 - odd) % 3;
+  const Scalar pi = Scalar(EIGEN_PI);
+
+  Eigen::Matrix<Scalar,3,1> res;
+  Scalar y, x; // arguments of atan2 for first angle
+  if (A0 == A2) {
+    y = coeff<j,i>(q);
+    x = coeff<k,i>(q);
+  } else {
+    y = coeff<j,k>(q);
+    x = coeff<k,k>(q);
+  }
+  res[0] = std::atan2(y, x);
+
+  // flip first angle by pi to keep it within Eigen's range [0:pi]
+  const bool flip = (odd && res[0] < Scalar(0)) || ((!odd) && res[0] > Scalar(0));
+  if (flip) res[0] += res[0] > Scalar(0) ? -pi : pi;
+
+  if (A0 == A2) {
+    const Scalar s2 = std::sqrt(y*y + x*x);
+    res[1] = flip ? -std::atan2(s2, coeff<i,i>(q)) : std::atan2(s2, coeff<i,i>(q));
+  } else {
+    const Scalar c2 = std::sqrt(coeff<i,i>(q)*coeff<i,i>(q) + coeff<i,j>(q)*coeff<i,j>(q));
+    res[1] = std::atan2(-coeff<i,k>(q), flip ? -c2 : c2);
+  }
+
+  // sine and cosine of first angle, avoiding trigonometric functions where possible
+  Scalar s1, c1;
+  const Scalar n = std::sqrt(y*y + x*x);
+  if (n > Eigen::NumTraits<Scalar>::epsilon()) {
+    s1 = (flip ? -y : y) / n;
+    c1 = (flip ? -x : x) / n;
+  } else {
+    s1 = std::sin(res[0]);
+    c1 = std::cos(res[0]);
+  }
+
+  if (A0 == A2)
+    res[2] = std::atan2(c1*coeff<j,k>(q) - s1*coeff<k,k>(q), c1*coeff<j,j>(q) - s1*coeff<k,j>(q));
+  else
+    res[2] = std::atan2(s1*coeff<k,i>(q) - c1*coeff<j,i>(q), c1*coeff<j,j>(q) - s1*coeff<k,j>(q));
+
+  if (!odd) res = -res;
+  return res;
+}
+
+/// quaternion from Euler angles of rotating axes A0,A1,A2
+template <int A0, int A1, int A2, typename Scalar>
+inline Eigen::Quaternion<Scalar> quaternion(Scalar e0, Scalar e1, Scalar e2)
+{
+  EIGEN_STATIC_ASSERT(A0 >= 0 && A0 < 3 && A1 >= 0 && A1 < 3 && A2 >= 0 && A2 < 3 &&
+                      A0 != A1 && A1 != A2, INVALID_EULER_AXES)
+  const Scalar c0 = std::cos(e0/2), s0 = std::sin(e0/2);
+  const Scalar c1 = std::cos(e1/2), s1 = std::sin(e1/2);
+  const Scalar c2 = std::cos(e2/2), s2 = std::sin(e2/2);
+
+  // q01 = R(A0,e0) * R(A1,e1): A0 x A1 = +/- A01
+  const int A01 = 3 - A0 - A1;
+  const Scalar sign = (A1 == (A0+1) % 3) ? Scalar(1) : Scalar(-1);
+  Scalar v[3];
+  v[A0] = s0*c1;
+  v[A1] = c0*s1;
+  v[A01] = sign * s0*s1;
+  const Scalar w = c0*c1;
+
+  // q = q01 * R(A2,e2)
+  const int B = (A2+1) % 3, C = (A2+2) % 3;
+  Eigen::Quaternion<Scalar> q;
+  q.w() = w*c2 - v[A2]*s2;
+  q.vec()[A2] = w*s2 + v[A2]*c2;
+  q.vec()[B] = v[B]*c2 + v[C]*s2;
+  q.vec()[C] = v[C]*c2 - v[B]*s2;
+  return q;
+}
+
+/** Euler convention with compile-time axes A0,A1,A2 w.r.t. the rotating (Fixed=false)
+ *  or static (Fixed=true) frame, providing straight-line conversion code for each convention.
+ */
+template <int A0, int A1, int A2, bool Fixed>
+struct EulerConvention
+{
+  static Eigen::Vector3d eulerAngles(const Eigen::Quaterniond &q)
+  {
+    if (!Fixed) return euler::eulerAngles<A0, A1, A2>(q);
+    // static axes A0,A1,A2 correspond to rotating axes A2,A1,A0 with reversed angles
+    const Eigen::Vector3d r = euler::eulerAngles<A2, A1, A0>(q);
+    return Eigen::Vector3d(r[2], r[1], r[0]);
+  }
+
+  static Eigen::Quaterniond quaternion(double e0, double e1, double e2)
+  {
+    return Fixed ? euler::quaternion<A2, A1, A0>(e2, e1, e0)
+                 : euler::quaternion<A0, A1, A2>(e0, e1, e2);
+  }
+
+  static void eulerAnglesBatch(const Eigen::Quaterniond *q, Eigen::Vector3d *e, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      e[i] = eulerAngles(q[i]);
+  }
+
+  static void quaternionBatch(const Eigen::Vector3d *e, Eigen::Quaterniond *q, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      q[i] = quaternion(e[i][0], e[i][1], e[i][2]);
+  }
+
+  /// structure-of-arrays conversion of rows [begin, end), q[k][i] being coefficient k (x,y,z,w) of row i
+  static void eulerAnglesSoA(const double *const q[4], double *const e[3],
+                             std::size_t begin, std::size_t end)
+  {
+    const double *EIGEN_RESTRICT qx = q[0], *EIGEN_RESTRICT qy = q[1];
+    const double *EIGEN_RESTRICT qz = q[2], *EIGEN_RESTRICT qw = q[3];
+    double *EIGEN_RESTRICT e0 = e[0], *EIGEN_RESTRICT e1 = e[1], *EIGEN_RESTRICT e2 = e[2];
+    for (std::size_t i = begin; i < end; ++i) {
+      const Eigen::Vector3d r = eulerAngles(Eigen::Quaterniond(qw[i], qx[i], qy[i], qz[i]));
+      e0[i] = r[0];
+      e1[i] = r[1];
+      e2[i] = r[2];
+    }
+  }
+
+  static void quaternionsSoA(const double *const e[3], double *const q[4],
+                             std::size_t begin, std::size_t end)
+  {
+    const double *EIGEN_RESTRICT e0 = e[0], *EIGEN_RESTRICT e1 = e[1], *EIGEN_RESTRICT e2 = e[2];
+    double *EIGEN_RESTRICT qx = q[0], *EIGEN_RESTRICT qy = q[1];
+    double *EIGEN_RESTRICT qz = q[2], *EIGEN_RESTRICT qw = q[3];
+    for (std::size_t i = begin; i < end; ++i) {
+      const Eigen::Quaterniond r = quaternion(e0[i], e1[i], e2[i]);
+      qx[i] = r.x();
+      qy[i] = r.y();
+      qz[i] = r.z();
+      qw[i] = r.w();
+    }
+  }
+};
+
+namespace detail
+{
+
+typedef void (*EulerAnglesFn)(const Eigen::Quaterniond *q, Eigen::Vector3d *e, std::size_t n);
+typedef void (*QuaternionFn)(const Eigen::Vector3d *e, Eigen::Quaterniond *q, std::size_t n);
+typedef void (*EulerAnglesSoAFn)(const double *const q[4], double *const e[3],
+                                 std::size_t begin, std::size_t end);
+typedef void (*QuaternionSoAFn)(const double *const e[3], double *const q[4],
+                                std::size_t begin, std::size_t end);
+
+/// entry of the runtime-to-template dispatch table
+struct ConventionFns
+{
+  EulerAnglesFn euler_angles;
+  QuaternionFn quaternions;
+  EulerAnglesSoAFn euler_angles_soa;
+  QuaternionSoAFn quaternions_soa;
+};
+
+#define AGNI_EULER_AXES(F, FIXED) \
+  F(0,1,0,FIXED) F(0,1,2,FIXED) F(0,2,0,FIXED) F(0,2,1,FIXED) \
+  F(1,0,1,FIXED) F(1,0,2,FIXED) F(1,2,0,FIXED) F(1,2,1,FIXED) \
+  F(2,0,1,FIXED) F(2,0,2,FIXED) F(2,1,0,FIXED) F(2,1,2,FIXED)
+
+#define AGNI_EULER_ENTRY(A0,A1,A2,FIXED) \
+  { &EulerConvention<A0,A1,A2,FIXED>::eulerAnglesBatch, \
+    &EulerConvention<A0,A1,A2,FIXED>::quaternionBatch, \
+    &EulerConvention<A0,A1,A2,FIXED>::eulerAnglesSoA, \
+    &EulerConvention<A0,A1,A2,FIXED>::quaternionsSoA },
+
+/// dispatch table of all 24 conventions, indexed by conventionIndex()
+static const ConventionFns CONVENTIONS[24] = {
+  AGNI_EULER_AXES(AGNI_EULER_ENTRY, false)
+  AGNI_EULER_AXES(AGNI_EULER_ENTRY, true)
+};
+
+#undef AGNI_EULER_ENTRY
+#undef AGNI_EULER_AXES
+
+/// index into CONVENTIONS, -1 for invalid axes
+inline int conventionIndex(const unsigned int a[3], bool fixed)
+{
+  if (a[0] > 2 || a[1] > 2 || a[2] > 2 || a[0] == a[1] || a[1] == a[2])
+    return -1;
+  // per first axis, there are 4 valid (A1,A2) pairs in lexicographical order
+  const unsigned int a1 = a[1] - (a[1] > a[0]); // index of A1 among 2 remaining axes
+  const unsigned int other = a[2] == a[0] ? 3 - a[0] - a[1] : a[0]; // alternative for A2
+  return fixed * 12 + a[0] * 4 + a1 * 2 + (a[2] > other);
+}
+
+} // namespace detail
+
+/** Runtime selection of one of the 24 EulerConventions
+ *
+ *  Axes are parsed from specs like "xyz", "szxz", or "rpy":
+ *  - 3 chars from [xyz] with consecutive axes being different
+ *  - optionally prefixed with 's' (static frame) or 'r' (rotating frame, default)
+ *  - aliases "rpy" (= "sxyz") and "ypr" (= "rzyx")
+ */
+class Convention
+{
+public:
+  /// rotating frame x-y-z
+  Convention() : fixed_(false), fns_(detail::CONVENTIONS[1])
+  {
+    axes_[0] = 0; axes_[1] = 1; axes_[2] = 2;
+  }
+
+  /// @return false for invalid axes, leaving the convention unchanged
+  bool set(const unsigned int axes[3], bool fixed)
+  {
+    const int index = detail::conventionIndex(axes, fixed);
+    if (index < 0) return false;
+    for (int i = 0; i < 3; ++i) axes_[i] = axes[i];
+    fixed_ = fixed;
+    fns_ = detail::CONVENTIONS[index];
+    return true;
+  }
+
+  /** set convention from axes spec
+   *  @param error optional description of the error, if spec is invalid
+   *  @return false for invalid specs, leaving the convention unchanged
+   */
+  bool parse(const std::string &spec, std::string *error = 0)
+  {
+    std::string s = spec;
+    if (s == "rpy") s = "sxyz";
+    else if (s == "ypr") s = "rzyx";
+
+    // static or rotating frame order?
+    bool fixed = false;
+    std::string::const_iterator pc = s.begin();
+    if (pc != s.end() && (*pc == 's' || *pc == 'r'))
+      fixed = (*pc++ == 's');
+
+    // need to have 3 axes specs
+    if (s.end() - pc != 3) {
+      if (error) *error = "Invalid axes spec: " + spec + ". Expecting 3 chars from [xyz]";
+      return false;
+    }
+
+    // parse axes specs into indexes
+    unsigned int axes[3];
+    for (int i = 0; i < 3; ++i, ++pc) {
+      if (*pc < 'x' || *pc > 'z') {
+        if (error) *error = std::string("invalid axis char: ") + *pc + " (only xyz allowed)";
+        return false;
+      }
+      axes[i] = *pc - 'x';
+    }
+    if (!set(axes, fixed)) {
+      if (error) *error = "consecutive axes need to be different";
+      return false;
+    }
+    return true;
+  }
+
+  const unsigned int* axes() const { return axes_; }
+  bool fixed() const { return fixed_; }
+
+  Eigen::Vector3d eulerAngles(const Eigen::Quaterniond &q) const
+  {
+    Eigen::Vector3d e;
+    fns_.euler_angles(&q, &e, 1);
+    return e;
+  }
+
+  Eigen::Quaterniond quaternion(double e0, double e1, double e2) const
+  {
+    const Eigen::Vector3d e(e0, e1, e2);
+    Eigen::Quaterniond q;
+    fns_.quaternions(&e, &q, 1);
+    return q;
+  }
+
+  /// batch conversion of n quaternions into Euler angles
+  void eulerAngles(const Eigen::Quaterniond *q, Eigen::Vector3d *e, std::size_t n) const
+  {
+    fns_.euler_angles(q, e, n);
+  }
+
+  /// batch conversion of n Euler angle triples into quaternions
+  void quaternions(const Eigen::Vector3d *e, Eigen::Quaterniond *q, std::size_t n) const
+  {
+    fns_.quaternions(e, q, n);
+  }
+
+  /** structure-of-arrays conversion of rows [begin, end)
+   *  @param q arrays of quaternion coefficients x, y, z, w
+   *  @param e arrays of first, second, and third Euler angle
+   *  See BulkConversion.h for a parallelized version.
+   */
+  void eulerAngles(const double *const q[4], double *const e[3],
+                   std::size_t begin, std::size_t end) const
+  {
+    fns_.euler_angles_soa(q, e, begin, end);
+  }
+
+  /// structure-of-arrays conversion of rows [begin, end), see eulerAngles()
+  void quaternions(const double *const e[3], double *const q[4],
+                   std::size_t begin, std::size_t end) const
+  {
+    fns_.quaternions_soa(e, q, begin, end);
+  }
+
+private:
+  unsigned int axes_[3];
+  bool fixed_;
+  detail::ConventionFns fns_;
+};
+
+/** Batch conversion of n quaternions into Euler angles about given axes.
+ *  @param fixed choose static (true) or rotating frame (false) convention
+ *  Axes need to be valid, i.e. from 0..2 with consecutive axes being different.
+ */
+inline void eulerAngles(const Eigen::Quaterniond *q, Eigen::Vector3d *e, std::size_t n,
+                        const unsigned int axes[3], bool fixed = false)
+{
+  detail::CONVENTIONS[detail::conventionIndex(axes, fixed)].euler_angles(q, e, n);
+}
+
+/// Batch conversion of n Euler angle triples about given axes into quaternions
+inline void quaternions(const Eigen::Vector3d *e, Eigen::Quaterniond *q, std::size_t n,
+                        const unsigned int axes[3], bool fixed = false)
+{
+  detail::CONVENTIONS[detail::conventionIndex(axes, fixed)].quaternions(e, q, n);
+}
+
+/// Euler angles of a single quaternion
+inline Eigen::Vector3d eulerAngles(const Eigen::Quaterniond &q,
+                                   const unsigned int axes[3], bool fixed = false)
+{
+  Eigen::Vector3d e;
+  eulerAngles(&q, &e, 1, axes, fixed);
+  return e;
+}
+
+/// quaternion of a single Euler angle triple
+inline Eigen::Quaterniond quaternion(const double e[3],
+                                     const unsigned int axes[3], bool fixed = false)
+{
+  const Eigen::Vector3d angles(e[0], e[1], e[2]);
+  Eigen::Quaterniond q;
+  quaternions(&angles, &q, 1, axes, fixed);
+  return q;
+}
+
+} // namespace euler
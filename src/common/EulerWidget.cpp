@@ -31,6 +31,8 @@
 
 #include "EulerWidget.h"
 #include "ui_euler.h"
+#include "EulerConversion.h"
+#include "SignalThrottle.h"
 
 #include <angles/angles.h>
 #include <QStandardItemModel>
@@ -50,6 +52,13 @@ static void disableAxis(QComboBox *w, unsigned int axis) {
   }
 }
 
+// the widget composes rotations w.r.t. the rotating frame
+static euler::Convention rotatingConvention(const uint a[3]) {
+  euler::Convention convention;
+  convention.set(a, false);
+  return convention;
+}
+
 EulerWidget::EulerWidget(QWidget *parent) :
   QWidget(parent), ui_(new Ui::EulerWidget)
 {
@@ -61,6 +70,8 @@ EulerWidget::EulerWidget(QWidget *parent) :
   ui_->a3->setCurrentIndex(2); disableAxis(ui_->a3, 1);
 
   q_ = Eigen::Quaterniond::Identity();
+  throttle_ = new SignalThrottle(0, this);
+  connect(throttle_, SIGNAL(triggered()), this, SLOT(emitValue()));
   updateAngles();
 
   // react to axis changes
@@ -119,10 +130,7 @@ void EulerWidget::angleChanged(double angle) {
 
 void EulerWidget::setEulerAngles(double e1, double e2, double e3, bool normalize) {
   uint a[3]; getGuiAxes(a);
-  Eigen::Quaterniond q =
-      Eigen::AngleAxisd(e1, Eigen::Vector3d::Unit(a[0])) *
-      Eigen::AngleAxisd(e2, Eigen::Vector3d::Unit(a[1])) *
-      Eigen::AngleAxisd(e3, Eigen::Vector3d::Unit(a[2]));
+  Eigen::Quaterniond q = rotatingConvention(a).quaternion(e1, e2, e3);
   if (normalize)
     setValue(q);
   else {
@@ -141,7 +149,8 @@ void EulerWidget::setEulerAngles(double e1, double e2, double e3, bool normalize
 
     if (q_.isApprox(q)) return;
     q_ = q;
-    emit valueChanged(q);
+    // angle edits (e.g. holding a spin box arrow) are coalesced
+    throttle_->trigger();
   }
 }
 
@@ -174,10 +183,22 @@ const Eigen::Quaterniond& EulerWidget::value() const {
   return q_;
 }
 
+int EulerWidget::throttleInterval() const {
+  return throttle_->interval();
+}
+
+void EulerWidget::setThrottleInterval(int ms) {
+  throttle_->setInterval(ms);
+}
+
+void EulerWidget::emitValue() {
+  emit valueChanged(q_);
+}
+
 
 void EulerWidget::updateAngles() {
   // ensure different axes for consecutive operations
   uint a[3]; getGuiAxes(a);
-  Eigen::Vector3d e = q_.matrix().eulerAngles(a[0], a[1], a[2]);
+  Eigen::Vector3d e = rotatingConvention(a).eulerAngles(q_);
   setEulerAngles(e[0], e[1], e[2], false);
 }
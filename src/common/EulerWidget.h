@@ -37,6 +37,7 @@
 namespace Ui {
 class EulerWidget;
 }
+class SignalThrottle;
 
 class EulerWidget : public QWidget
 {
@@ -53,6 +54,10 @@ public:
   /// retrieve angles from GUI
   void getGuiAngles(double e[]) const;
 
+  /// minimum interval (ms) between valueChanged() signals caused by angle edits, 0 = unlimited
+  int throttleInterval() const;
+  void setThrottleInterval(int ms);
+
 signals:
   /// quaternion value has changed
   void valueChanged(const Eigen::Quaterniond &q);
@@ -70,8 +75,10 @@ protected slots:
 
 private slots:
   void updateAngles();
+  void emitValue();
 
 private:
   Eigen::Quaterniond q_;
+  SignalThrottle *throttle_;
   Ui::EulerWidget *ui_;
 };
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include "FrameId.h"
+#include <QHash>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <map>
+
+namespace
+{
+
+const std::string *emptyName()
+{
+  static const std::string empty; // function-local: safe to use during static initialization
+  return &empty;
+}
+
+struct Entry
+{
+  unsigned int id;
+  const std::string *name;
+};
+
+/// process-wide table of interned names
+struct FrameTable
+{
+  boost::mutex mutex;
+  std::deque<std::string> names; // deque keeps references stable while growing
+  std::map<std::string, Entry> entries;
+  QHash<QString, Entry> qt_entries; // cache for QString lookups
+
+  Entry intern(const std::string &name)
+  {
+    if (name.empty()) {
+      const Entry empty = { 0, emptyName() };
+      return empty;
+    }
+    std::map<std::string, Entry>::const_iterator it = entries.find(name);
+    if (it != entries.end()) return it->second;
+
+    names.push_back(name);
+    const Entry entry = { static_cast<unsigned int>(names.size()), &names.back() };
+    entries.insert(std::make_pair(name, entry));
+    return entry;
+  }
+};
+
+FrameTable &table()
+{
+  static FrameTable instance;
+  return instance;
+}
+
+} // anonymous namespace
+
+FrameId::FrameId() : id_(0), name_(emptyName())
+{
+}
+
+FrameId::FrameId(const std::string &name)
+{
+  FrameTable &t = table();
+  boost::mutex::scoped_lock lock(t.mutex);
+  const Entry entry = t.intern(name);
+  id_ = entry.id;
+  name_ = entry.name;
+}
+
+FrameId::FrameId(const QString &name)
+{
+  FrameTable &t = table();
+  boost::mutex::scoped_lock lock(t.mutex);
+  QHash<QString, Entry>::const_iterator it = t.qt_entries.constFind(name);
+  if (it == t.qt_entries.constEnd())
+    it = t.qt_entries.insert(name, t.intern(name.toStdString()));
+  id_ = it->id;
+  name_ = it->name;
+}
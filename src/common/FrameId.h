@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#pragma once
+
+#include <QString>
+#include <string>
+
+/** Interned tf frame name
+ *
+ *  Each distinct frame name is stored once in a process-wide table and identified
+ *  by a small integer. Hence, frames are compared by integer and message strings
+ *  only need to be (re)assigned when a frame actually changes.
+ *  Interned names are never released: applications only use a limited set of frames.
+ *  Interning is thread-safe, accessing id() and str() is lock-free.
+ */
+class FrameId
+{
+public:
+  /// empty frame name, id 0
+  FrameId();
+  /// intern given frame name
+  explicit FrameId(const std::string &name);
+  /// intern given frame name, avoiding the conversion to std::string for known names
+  explicit FrameId(const QString &name);
+
+  unsigned int id() const { return id_; }
+  const std::string &str() const { return *name_; }
+  bool empty() const { return id_ == 0; }
+
+  bool operator==(const FrameId &other) const { return id_ == other.id_; }
+  bool operator!=(const FrameId &other) const { return id_ != other.id_; }
+  bool operator<(const FrameId &other) const { return id_ < other.id_; }
+
+private:
+  unsigned int id_;
+  const std::string *name_; // interned name, stable for the process lifetime
+};
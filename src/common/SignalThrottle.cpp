@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include "SignalThrottle.h"
+#include <QTimer>
+
+SignalThrottle::SignalThrottle(int interval_ms, QObject *parent) :
+  QObject(parent), interval_(qMax(0, interval_ms))
+{
+  timer_ = new QTimer(this);
+  timer_->setSingleShot(true);
+  connect(timer_, SIGNAL(timeout()), this, SLOT(emitTriggered()));
+}
+
+int SignalThrottle::interval() const
+{
+  return interval_;
+}
+
+void SignalThrottle::setInterval(int ms)
+{
+  interval_ = qMax(0, ms);
+  if (interval_ == 0) flush();
+}
+
+bool SignalThrottle::pending() const
+{
+  return timer_->isActive();
+}
+
+void SignalThrottle::trigger()
+{
+  if (timer_->isActive()) return; // trailing emission already scheduled
+
+  const qint64 elapsed = last_.isValid() ? last_.elapsed() : interval_;
+  if (interval_ == 0 || elapsed >= interval_)
+    emitTriggered(); // leading edge
+  else
+    timer_->start(static_cast<int>(interval_ - elapsed));
+}
+
+void SignalThrottle::flush()
+{
+  if (timer_->isActive()) emitTriggered();
+}
+
+void SignalThrottle::emitTriggered()
+{
+  timer_->stop();
+  last_.start();
+  emit triggered();
+}
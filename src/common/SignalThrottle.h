@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+
+class QTimer;
+
+/** Time-based coalescing of frequent notifications, e.g. from spin boxes
+ *
+ *  trigger() emits triggered() immediately (leading edge), if the last emission is
+ *  at least interval() ago. Otherwise, a single emission is scheduled at the end of
+ *  the interval (trailing edge), such that the final state is always delivered.
+ *  An interval of 0 disables throttling.
+ */
+class SignalThrottle : public QObject
+{
+  Q_OBJECT
+public:
+  explicit SignalThrottle(int interval_ms = 0, QObject *parent = 0);
+
+  /// minimum interval between emissions in ms
+  int interval() const;
+  void setInterval(int ms);
+  /// is a trailing emission pending?
+  bool pending() const;
+
+signals:
+  void triggered();
+
+public slots:
+  void trigger();
+  /// immediately emit a pending trailing emission
+  void flush();
+
+private slots:
+  void emitTriggered();
+
+private:
+  int interval_;
+  QTimer *timer_;
+  QElapsedTimer last_;
+};
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include "StaticTransformRegistry.h"
+#include "ChunkedTransformPublisher.h"
+#include <boost/weak_ptr.hpp>
+#include <QTimer>
+
+StaticTransformRegistry::Ptr StaticTransformRegistry::instance()
+{
+  static boost::weak_ptr<StaticTransformRegistry> instance;
+  Ptr result = instance.lock();
+  if (!result) {
+    result.reset(new StaticTransformRegistry());
+    instance = result;
+  }
+  return result;
+}
+
+StaticTransformRegistry::StaticTransformRegistry() :
+  chunks_(0), net_message_(new tf2_msgs::TFMessage()), running_(true)
+{
+  timer_ = new QTimer(this);
+  timer_->setSingleShot(true);
+  connect(timer_, SIGNAL(timeout()), this, SLOT(flush()));
+  // publishers and thread are created on first enqueue()
+}
+
+StaticTransformRegistry::~StaticTransformRegistry()
+{
+  if (timer_->isActive()) flush();
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cond_.notify_one();
+  if (thread_.joinable())
+    thread_.join(); // publishes remaining requests
+}
+
+const std::vector<geometry_msgs::TransformStamped> &StaticTransformRegistry::transforms() const
+{
+  return net_message_->transforms;
+}
+
+void StaticTransformRegistry::setChunks(unsigned int chunks)
+{
+  if (thread_.joinable() && chunks != chunks_)
+    ROS_WARN("StaticTransformRegistry: chunking can only be changed before publishing");
+  else
+    chunks_ = chunks;
+}
+
+tf2_msgs::TFMessage &StaticTransformRegistry::writable()
+{
+  // a snapshot still queued or retained by the publisher must not change
+  if (!net_message_.unique())
+    net_message_.reset(new tf2_msgs::TFMessage(*net_message_));
+  return *net_message_;
+}
+
+static bool dropClaim(std::vector<std::pair<const void*, geometry_msgs::TransformStamped> > &claims,
+                      const void *owner)
+{
+  for (size_t i = 0; i < claims.size(); ++i) {
+    if (claims[i].first != owner) continue;
+    claims.erase(claims.begin() + i);
+    return true;
+  }
+  return false;
+}
+
+void StaticTransformRegistry::update(const geometry_msgs::TransformStamped &msg, const void *owner,
+                                     const std::string &prev_child_frame)
+{
+  if (prev_child_frame != msg.child_frame_id)
+    erase(prev_child_frame, owner);
+
+  std::vector<geometry_msgs::TransformStamped> &tfs = writable().transforms;
+  std::map<std::string, Entry>::iterator it = index_.find(msg.child_frame_id);
+  if (it == index_.end()) {
+    Entry &entry = index_[msg.child_frame_id];
+    entry.index = tfs.size();
+    entry.owner = owner;
+    tfs.push_back(msg);
+  } else {
+    Entry &entry = it->second;
+    if (entry.owner != owner) { // most recent owner wins, keep the other one's transform
+      if (!dropClaim(entry.shadowed, owner))
+        ROS_WARN_STREAM("StaticTransformRegistry: several publishers of child frame '"
+                        << msg.child_frame_id << "', publishing the most recent one");
+      entry.shadowed.push_back(Claim(entry.owner, tfs[entry.index]));
+      entry.owner = owner;
+    }
+    tfs[entry.index] = msg;
+  }
+
+  publish();
+}
+
+void StaticTransformRegistry::remove(const std::string &child_frame, const void *owner)
+{
+  if (erase(child_frame, owner))
+    publish();
+}
+
+bool StaticTransformRegistry::erase(const std::string &child_frame, const void *owner)
+{
+  std::map<std::string, Entry>::iterator it = index_.find(child_frame);
+  if (it == index_.end()) return false;
+
+  Entry &entry = it->second;
+  if (entry.owner != owner) { // published transform stays
+    dropClaim(entry.shadowed, owner);
+    return false;
+  }
+
+  std::vector<geometry_msgs::TransformStamped> &tfs = writable().transforms;
+  if (!entry.shadowed.empty()) { // fall back to the previous owner's transform
+    entry.owner = entry.shadowed.back().first;
+    tfs[entry.index] = entry.shadowed.back().second;
+    entry.shadowed.pop_back();
+    return true;
+  }
+
+  // keep array contiguous: move last element into the freed slot
+  const size_t idx = entry.index;
+  index_.erase(it);
+  if (idx + 1 != tfs.size()) {
+    tfs[idx] = tfs.back();
+    index_[tfs[idx].child_frame_id].index = idx;
+  }
+  tfs.pop_back();
+  return true;
+}
+
+void StaticTransformRegistry::stream(const geometry_msgs::TransformStamped &msg)
+{
+  tf2_msgs::TFMessagePtr tf(new tf2_msgs::TFMessage());
+  tf->transforms.push_back(msg);
+  enqueue(tf, false);
+}
+
+void StaticTransformRegistry::publish()
+{
+  if (!timer_->isActive()) timer_->start(0);
+}
+
+void StaticTransformRegistry::flush()
+{
+  timer_->stop();
+  enqueue(net_message_, true); // shared snapshot, see writable()
+}
+
+void StaticTransformRegistry::enqueue(const tf2_msgs::TFMessageConstPtr &msg, bool latched)
+{
+  Request request = { msg, latched };
+  // only blocks if the publisher thread is way behind
+  while (!queue_.push(request))
+    boost::this_thread::yield();
+  if (!thread_.joinable())
+    thread_ = boost::thread(&StaticTransformRegistry::run, this);
+  // empty critical section: avoid missing the wakeup in run()
+  { boost::lock_guard<boost::mutex> lock(mutex_); }
+  cond_.notify_one();
+}
+
+void StaticTransformRegistry::run()
+{
+  Request request;
+  while (true) {
+    tf2_msgs::TFMessageConstPtr latched; // only the latest latched message matters
+    while (queue_.pop(request)) {
+      if (request.latched)
+        latched = request.msg;
+      else {
+        advertise(dynamic_pub_, "/tf", false);
+        dynamic_pub_.publish(request.msg);
+      }
+    }
+    if (latched) {
+      if (chunks_ > 0) { // only re-send changed chunks
+        if (!chunked_pub_) chunked_pub_.reset(new ChunkedTransformPublisher("/tf_static", chunks_));
+        chunked_pub_->publish(latched->transforms);
+      } else {
+        advertise(pub_, "/tf_static", true);
+        pub_.publish(latched);
+      }
+      continue;
+    }
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (queue_.read_available() > 0) continue;
+    if (!running_) break;
+    cond_.wait(lock);
+  }
+}
+
+void StaticTransformRegistry::advertise(ros::Publisher &pub, const std::string &topic, bool latched)
+{
+  // registering with the master happens in the publisher thread, not blocking the GUI
+  if (!pub) pub = nh_.advertise<tf2_msgs::TFMessage>(topic, 100, latched);
+}
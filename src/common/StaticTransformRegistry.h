@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#pragma once
+
+#include <QObject>
+#include <ros/ros.h>
+#include <tf2_msgs/TFMessage.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/atomic.hpp>
+#include <map>
+
+class QTimer;
+class ChunkedTransformPublisher;
+
+/** Process-wide collection of static transforms, keyed by child frame.
+ *
+ *  All transforms of the process are kept in a single flat TFMessage,
+ *  which is published via one latched /tf_static publisher.
+ *  Each entry is owned by the broadcaster that published it. If several owners publish
+ *  the same child frame, the most recent update wins, a warning is issued, and removing
+ *  one owner's transform falls back to the remaining owner's one.
+ *
+ *  As a latched topic only retains the last message, each update needs to
+ *  publish the whole set. However, this happens from a single publisher,
+ *  instead of one (competing) publisher per static transform broadcaster.
+ *
+ *  Changes are collected during one Qt event-loop iteration and published once,
+ *  e.g. when loading many transforms at once.
+ *  Messages are serialized and sent from a dedicated publisher thread:
+ *  update(), remove() and stream() only hand over a snapshot via a lock-free
+ *  single-producer queue. Hence, they must be called from a single thread,
+ *  usually the Qt GUI thread.
+ *  The publisher thread is started, and the topics are advertised, on first use only.
+ *  The set is shared with queued/published messages (copy-on-write): it is only cloned
+ *  when modified while a previous snapshot is still referenced.
+ *
+ *  Optionally, large sets can be published in content-hashed chunks instead,
+ *  only re-sending changed chunks (see ChunkedTransformPublisher).
+ */
+class StaticTransformRegistry : public QObject
+{
+  Q_OBJECT
+public:
+  typedef boost::shared_ptr<StaticTransformRegistry> Ptr;
+
+  /// retrieve shared instance, which lives as long as somebody holds a reference
+  static Ptr instance();
+
+  /** add or update the transform for msg.child_frame_id
+   *  @param owner identifies the publisher of the transform, usually its this pointer
+   *  @param prev_child_frame previously used child frame of this transform, to be replaced
+   */
+  void update(const geometry_msgs::TransformStamped &msg, const void *owner,
+              const std::string &prev_child_frame = std::string());
+  /// remove owner's transform for given child frame
+  void remove(const std::string &child_frame, const void *owner);
+  /// send transform to (non-static) /tf, e.g. while interactively dragging a frame
+  void stream(const geometry_msgs::TransformStamped &msg);
+
+  const std::vector<geometry_msgs::TransformStamped>& transforms() const;
+
+  /** publish /tf_static in given number of chunks (0: single latched message)
+   *  Only effective before the first transform is published.
+   */
+  void setChunks(unsigned int chunks);
+
+  ~StaticTransformRegistry();
+
+private slots:
+  /// publish pending changes
+  void flush();
+
+private:
+  StaticTransformRegistry();
+  /// @return true if the published set changed
+  bool erase(const std::string &child_frame, const void *owner);
+  /// unshare net_message_ before modifying it
+  tf2_msgs::TFMessage &writable();
+  void publish(); // schedule flush() for next event-loop iteration
+  void enqueue(const tf2_msgs::TFMessageConstPtr &msg, bool latched);
+  void run(); // publisher thread
+  void advertise(ros::Publisher &pub, const std::string &topic, bool latched);
+
+  struct Request {
+    tf2_msgs::TFMessageConstPtr msg;
+    bool latched; // /tf_static or /tf?
+  };
+
+  ros::NodeHandle nh_;
+  ros::Publisher pub_;
+  ros::Publisher dynamic_pub_;
+  boost::atomic<unsigned int> chunks_;
+  boost::scoped_ptr<ChunkedTransformPublisher> chunked_pub_; // replaces pub_ in chunked mode
+  tf2_msgs::TFMessagePtr net_message_; // all transforms, shared with publisher thread
+  typedef std::pair<const void*, geometry_msgs::TransformStamped> Claim;
+  struct Entry {
+    size_t index; // index into net_message_
+    const void *owner; // owner of the published transform
+    std::vector<Claim> shadowed; // transforms of other owners of the same child frame
+  };
+  std::map<std::string, Entry> index_; // child frame -> entry
+  QTimer *timer_; // pending flush()
+
+  boost::lockfree::spsc_queue<Request, boost::lockfree::capacity<64> > queue_;
+  boost::mutex mutex_; // only guards waiting for queue_ in run()
+  boost::condition_variable cond_;
+  boost::atomic<bool> running_;
+  boost::thread thread_;
+};
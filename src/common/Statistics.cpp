@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include "Statistics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+void LatencyHistogram::reset()
+{
+  std::fill(buckets_, buckets_ + BUCKETS, 0);
+  count_ = 0;
+  sum_ = 0;
+  max_ = 0;
+}
+
+void LatencyHistogram::add(double seconds)
+{
+  unsigned long us = seconds > 0 ? static_cast<unsigned long>(seconds * 1e6) : 0;
+  int bucket = 0;
+  while (us && bucket < BUCKETS-1) {
+    us >>= 1;
+    ++bucket;
+  }
+  ++buckets_[bucket];
+  ++count_;
+  sum_ += seconds;
+  max_ = std::max(max_, seconds);
+}
+
+double LatencyHistogram::percentile(double p) const
+{
+  const double threshold = p * count_;
+  unsigned long cumulated = 0;
+  for (int i = 0; i < BUCKETS-1; ++i) {
+    cumulated += buckets_[i];
+    if (cumulated >= threshold)
+      return std::ldexp(1e-6, i);
+  }
+  return max_;
+}
+
+static std::string formatDuration(double seconds)
+{
+  char buffer[32];
+  if (seconds < 1e-3)
+    std::snprintf(buffer, sizeof(buffer), "%.0f us", seconds * 1e6);
+  else
+    std::snprintf(buffer, sizeof(buffer), "%.2f ms", seconds * 1e3);
+  return buffer;
+}
+
+std::string LatencyHistogram::summary() const
+{
+  if (!count_) return "no samples";
+  return "mean " + formatDuration(mean()) +
+      ", p99 < " + formatDuration(percentile(0.99)) +
+      ", max " + formatDuration(max());
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#pragma once
+
+#include <string>
+
+/** Histogram of durations with logarithmic buckets
+ *
+ *  Bucket i counts durations in [2^(i-1), 2^i) microseconds, the last one all longer durations.
+ *  Adding a sample is cheap enough to be used in hot paths.
+ */
+class LatencyHistogram
+{
+public:
+  enum { BUCKETS = 24 };
+
+  LatencyHistogram();
+  void reset();
+  /// add a duration given in seconds
+  void add(double seconds);
+
+  unsigned long count() const { return count_; }
+  double mean() const { return count_ ? sum_ / count_ : 0.0; }
+  double max() const { return max_; }
+  /// upper bound (in seconds) of the bucket holding the p-quantile (0 < p <= 1)
+  double percentile(double p) const;
+
+  /// human-readable summary, e.g. "mean 0.1 ms, p99 < 0.3 ms, max 1.2 ms"
+  std::string summary() const;
+
+private:
+  unsigned long buckets_[BUCKETS];
+  unsigned long count_;
+  double sum_;
+  double max_;
+};
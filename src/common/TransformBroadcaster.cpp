@@ -30,10 +30,20 @@
  */
 
 #include "TransformBroadcaster.h"
+#include <QTimer>
+#include <utility>
 
 TransformBroadcaster::TransformBroadcaster(const QString &parent_frame, const QString &child_frame, QObject *parent) :
-  QObject(parent), valid_(false), enabled_(false)
+  QObject(parent),
+  valid_(false), enabled_(false),
+  coalesce_(true), pending_(false), min_interval_(0),
+  dynamic_(false), dynamic_interval_(qRound(1000.0 / 30)),
+  translation_tolerance_(1e-6), angle_tolerance_(1e-6)
 {
+  timer_ = new QTimer(this);
+  timer_->setSingleShot(true);
+  connect(timer_, SIGNAL(timeout()), this, SLOT(flush()));
+
   setPosition(0,0,0);
   setQuaternion(0,0,0,1);
 
@@ -44,6 +54,25 @@ TransformBroadcaster::TransformBroadcaster(const QString &parent_frame, const QS
   check(); send();
 }
 
+TransformBroadcaster::~TransformBroadcaster()
+{
+  // pending changes become obsolete: the transform is removed anyway
+  timer_->stop();
+  if (!published_child_.empty())
+    registry_->remove(published_child_.str(), this);
+}
+
+StaticTransformRegistry &TransformBroadcaster::registry()
+{
+  if (!registry_) registry_ = StaticTransformRegistry::instance();
+  return *registry_;
+}
+
+const TransformBroadcaster::Statistics &TransformBroadcaster::statistics() const
+{
+  return stats_;
+}
+
 const geometry_msgs::TransformStamped &TransformBroadcaster::value() const
 {
   return msg_;
@@ -52,24 +81,42 @@ const geometry_msgs::TransformStamped &TransformBroadcaster::value() const
 void TransformBroadcaster::setValue(const geometry_msgs::TransformStamped &tf)
 {
   msg_ = tf;
+  parent_ = FrameId(msg_.header.frame_id);
+  child_ = FrameId(msg_.child_frame_id);
   check(); send();
 }
 
-void TransformBroadcaster::setPose(const geometry_msgs::Pose &pose)
+void TransformBroadcaster::setValue(geometry_msgs::TransformStamped &&tf)
 {
-  bool old = enabled_;
-  enabled_ = false;
-
-  const geometry_msgs::Point &p = pose.position;
-  setPosition(p.x, p.y, p.z);
+  msg_ = std::move(tf);
+  parent_ = FrameId(msg_.header.frame_id);
+  child_ = FrameId(msg_.child_frame_id);
+  check(); send();
+}
 
-  const geometry_msgs::Quaternion &q = pose.orientation;
-  setQuaternion(q.x, q.y, q.z, q.w);
+void TransformBroadcaster::setValue(const FrameId &parent_frame, const FrameId &child_frame,
+                                    const geometry_msgs::Pose &pose)
+{
+  if (assignFrames(parent_frame, child_frame)) check();
+  assignPose(pose);
+  send();
+}
 
-  enabled_ = old;
+void TransformBroadcaster::setPose(const geometry_msgs::Pose &pose)
+{
+  assignPose(pose);
   send();
 }
 
+void TransformBroadcaster::assignPose(const geometry_msgs::Pose &pose)
+{
+  const geometry_msgs::Point &p = pose.position;
+  msg_.transform.translation.x = p.x;
+  msg_.transform.translation.y = p.y;
+  msg_.transform.translation.z = p.z;
+  msg_.transform.rotation = pose.orientation;
+}
+
 bool TransformBroadcaster::enabled() const
 {
   return enabled_;
@@ -88,16 +135,44 @@ void TransformBroadcaster::setDisabled(bool bDisabled)
 
 void TransformBroadcaster::setParentFrame(const QString &frame)
 {
-  msg_.header.frame_id = frame.toStdString();
-  check(); send();
+  setParentFrame(FrameId(frame));
 }
 
 void TransformBroadcaster::setChildFrame(const QString &frame)
 {
-  msg_.child_frame_id = frame.toStdString();
+  setChildFrame(FrameId(frame));
+}
+
+void TransformBroadcaster::setParentFrame(const FrameId &frame)
+{
+  setFrames(frame, child_);
+}
+
+void TransformBroadcaster::setChildFrame(const FrameId &frame)
+{
+  setFrames(parent_, frame);
+}
+
+void TransformBroadcaster::setFrames(const FrameId &parent_frame, const FrameId &child_frame)
+{
+  if (!assignFrames(parent_frame, child_frame)) return;
   check(); send();
 }
 
+bool TransformBroadcaster::assignFrames(const FrameId &parent_frame, const FrameId &child_frame)
+{
+  if (parent_frame == parent_ && child_frame == child_) return false;
+  if (parent_frame != parent_) {
+    parent_ = parent_frame;
+    msg_.header.frame_id = parent_.str();
+  }
+  if (child_frame != child_) {
+    child_ = child_frame;
+    msg_.child_frame_id = child_.str();
+  }
+  return true;
+}
+
 void TransformBroadcaster::setPosition(const Eigen::Vector3d &p)
 {
   setPosition(p.x(), p.y(), p.z());
@@ -125,20 +200,171 @@ void TransformBroadcaster::setQuaternion(double x, double y, double z, double w)
   send();
 }
 
+bool TransformBroadcaster::coalescing() const
+{
+  return coalesce_;
+}
+
+double TransformBroadcaster::maxRate() const
+{
+  return min_interval_ > 0 ? 1000.0 / min_interval_ : 0.0;
+}
+
+void TransformBroadcaster::setCoalescing(bool bCoalesce)
+{
+  coalesce_ = bCoalesce;
+  if (!coalesce_) flush();
+}
+
+void TransformBroadcaster::setMaxRate(double rate)
+{
+  min_interval_ = rate > 0 ? qRound(1000.0 / rate) : 0;
+}
+
+bool TransformBroadcaster::dynamic() const
+{
+  return dynamic_;
+}
+
+double TransformBroadcaster::dynamicRate() const
+{
+  return dynamic_interval_ > 0 ? 1000.0 / dynamic_interval_ : 0.0;
+}
+
+void TransformBroadcaster::setDynamic(bool bDynamic)
+{
+  if (dynamic_ == bDynamic) return;
+  if (!bDynamic) timer_->stop(); // pending dynamic update becomes obsolete
+
+  dynamic_ = bDynamic;
+  streamed_child_ = FrameId(); // nothing streamed yet
+  if (!dynamic_) { // commit final transform to /tf_static
+    pending_ = false;
+    send();
+  }
+}
+
+void TransformBroadcaster::setDynamicRate(double rate)
+{
+  dynamic_interval_ = rate > 0 ? qRound(1000.0 / rate) : 0;
+}
+
+double TransformBroadcaster::translationTolerance() const
+{
+  return translation_tolerance_;
+}
+
+double TransformBroadcaster::angleTolerance() const
+{
+  return angle_tolerance_;
+}
+
+void TransformBroadcaster::setTolerance(double translation, double angle)
+{
+  translation_tolerance_ = qMax(0.0, translation);
+  angle_tolerance_ = qMax(0.0, angle);
+}
+
+void TransformBroadcaster::flush()
+{
+  timer_->stop();
+  if (pending_) publish();
+}
+
 void TransformBroadcaster::send()
 {
+  ++stats_.requests;
+  if (enabled_ && !valid_) ++stats_.rejected;
+  // nothing to publish nor to remove?
+  if ((!enabled_ || !valid_) && published_child_.empty()) return;
+  // transform already published? pending publishes re-check in publish()
+  if (!pending_ && !changed()) {
+    ++stats_.duplicates;
+    return;
+  }
+  if (!coalesce_) {
+    pending_since_ = ros::WallTime::now();
+    publish();
+    return;
+  }
+
+  if (pending_) ++stats_.coalesced;
+  else pending_since_ = ros::WallTime::now();
+  pending_ = true;
+  if (timer_->isActive()) return; // publishing already scheduled
+
+  // delay publishing to next event-loop iteration or according to rate limit
+  const int interval = dynamic_ ? qMax(min_interval_, dynamic_interval_) : min_interval_;
+  qint64 delay = 0;
+  if (interval > 0 && last_publish_.isValid())
+    delay = qMax(qint64(0), interval - last_publish_.elapsed());
+  timer_->start(static_cast<int>(delay));
+}
+
+void TransformBroadcaster::publish()
+{
+  pending_ = false;
+  if (!changed()) { // pending changes were reverted
+    ++stats_.duplicates;
+    return;
+  }
   if (enabled_ && valid_) {
     msg_.header.stamp = ros::Time::now();
     ++msg_.header.seq;
-    broadcaster_.sendTransform(msg_);
-    ros::spinOnce();
-  }
+    if (dynamic_) {
+      registry().stream(msg_);
+      streamed_ = msg_.transform;
+      streamed_parent_ = parent_;
+      streamed_child_ = child_;
+      ++stats_.dynamic_publishes;
+    } else {
+      registry().update(msg_, this, published_child_.str());
+      published_ = msg_.transform;
+      published_parent_ = parent_;
+      published_child_ = child_;
+      ++stats_.publishes;
+    }
+  } else if (!published_child_.empty()) {
+    registry_->remove(published_child_.str(), this);
+    published_child_ = FrameId();
+  } else
+    return;
+
+  // actual sending happens asynchronously in the registry's publisher thread
+  stats_.latency.add((ros::WallTime::now() - pending_since_).toSec());
+  last_publish_.start();
 }
 
 void TransformBroadcaster::check()
 {
-  valid_ =
-      !msg_.header.frame_id.empty() &&
-      !msg_.child_frame_id.empty() &&
-      msg_.header.frame_id != msg_.child_frame_id;
+  valid_ = !parent_.empty() && !child_.empty() && parent_ != child_;
+}
+
+/// compare poses of a and b, frames are compared by the caller
+static bool isClose(const geometry_msgs::Transform &a,
+                    const geometry_msgs::Transform &b,
+                    double translation_tolerance, double angle_tolerance)
+{
+  const geometry_msgs::Vector3 &ta = a.translation;
+  const geometry_msgs::Vector3 &tb = b.translation;
+  const Eigen::Vector3d dt(ta.x - tb.x, ta.y - tb.y, ta.z - tb.z);
+  if (dt.norm() > translation_tolerance) return false;
+
+  const geometry_msgs::Quaternion &ra = a.rotation;
+  const geometry_msgs::Quaternion &rb = b.rotation;
+  if (ra.x == rb.x && ra.y == rb.y && ra.z == rb.z && ra.w == rb.w) return true;
+  const Eigen::Quaterniond qa(ra.w, ra.x, ra.y, ra.z);
+  const Eigen::Quaterniond qb(rb.w, rb.x, rb.y, rb.z);
+  return qa.normalized().angularDistance(qb.normalized()) <= angle_tolerance;
+}
+
+bool TransformBroadcaster::changed() const
+{
+  if (!enabled_ || !valid_) // transform should be removed
+    return !published_child_.empty();
+  if (dynamic_)
+    return streamed_child_.empty() || streamed_child_ != child_ || streamed_parent_ != parent_ ||
+        !isClose(msg_.transform, streamed_, translation_tolerance_, angle_tolerance_);
+  return published_child_.empty() || published_child_ != child_ || published_parent_ != parent_ ||
+      !isClose(msg_.transform, published_, translation_tolerance_, angle_tolerance_);
 }
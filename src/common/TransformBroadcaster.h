@@ -32,12 +32,32 @@
 #pragma once
 
 #include <QObject>
-#include <tf2_ros/static_transform_broadcaster.h>
+#include <QElapsedTimer>
+#include <geometry_msgs/TransformStamped.h>
 #include <geometry_msgs/Pose.h>
 #include <Eigen/Geometry>
 
-/** QObject wrapper for tf2_ros::StaticTransformBroadcaster
+#include "StaticTransformRegistry.h"
+#include "FrameId.h"
+#include "Statistics.h"
+
+class QTimer;
+
+/** QObject wrapper publishing a static transform via the StaticTransformRegistry
  *  to allow for signal-slot interaction
+ *
+ *  While disabled or invalid, the transform is removed from the latched set.
+ *  The shared StaticTransformRegistry is only acquired on first publish.
+ *
+ *  In coalescing mode (default), changes only mark the message dirty.
+ *  It is published once per Qt event-loop iteration, or at most with maxRate().
+ *
+ *  In dynamic mode, e.g. while interactively dragging a frame, the transform is
+ *  streamed to /tf instead (at most with dynamicRate()). Leaving dynamic mode
+ *  commits the final transform to /tf_static.
+ *
+ *  Requests not changing the transform beyond translationTolerance() and
+ *  angleTolerance() w.r.t. the last published message are dropped.
  */
 class TransformBroadcaster : public QObject
 {
@@ -46,13 +66,52 @@ public:
   explicit TransformBroadcaster(const QString &parent_frame="",
                                 const QString &child_frame="",
                                 QObject *parent = 0);
+  ~TransformBroadcaster();
+
+  /// counters for instrumentation
+  struct Statistics {
+    Statistics() : requests(0), publishes(0), dynamic_publishes(0),
+      rejected(0), coalesced(0), duplicates(0) {}
+    unsigned long requests; ///< number of send() requests
+    unsigned long publishes; ///< number of published (static) messages
+    unsigned long dynamic_publishes; ///< number of messages streamed to /tf
+    unsigned long rejected; ///< requests rejected due to invalid frames
+    unsigned long coalesced; ///< requests merged into an already pending publish
+    unsigned long duplicates; ///< requests dropped because the transform didn't change
+    LatencyHistogram latency; ///< delay from first pending request until publishing
+  };
+  const Statistics& statistics() const;
 
   const geometry_msgs::TransformStamped& value() const;
   void setValue(const geometry_msgs::TransformStamped &tf);
+  /// take over frame strings of tf instead of copying them
+  void setValue(geometry_msgs::TransformStamped &&tf);
   void setPose(const geometry_msgs::Pose &pose);
+  /// set interned frames, only rebuilding message strings when they actually change
+  void setFrames(const FrameId &parent_frame, const FrameId &child_frame);
+  /// set frames and pose at once
+  void setValue(const FrameId &parent_frame, const FrameId &child_frame,
+                const geometry_msgs::Pose &pose);
+  void setParentFrame(const FrameId &frame);
+  void setChildFrame(const FrameId &frame);
+  const FrameId& parentFrame() const { return parent_; }
+  const FrameId& childFrame() const { return child_; }
 
   bool enabled() const;
 
+  bool coalescing() const;
+  /// publish rate limit in Hz in coalescing mode, 0 means once per event-loop iteration
+  double maxRate() const;
+
+  bool dynamic() const;
+  /// publish rate limit in Hz in dynamic mode
+  double dynamicRate() const;
+
+  /// translation distance (m) below which changes are ignored
+  double translationTolerance() const;
+  /// rotation angle (rad) below which changes are ignored
+  double angleTolerance() const;
+
 public slots:
   void setEnabled(bool bEnabled=true);
   void setDisabled(bool bDisabled=true);
@@ -66,13 +125,54 @@ public slots:
   void setPosition(double x, double y, double z);
   void setQuaternion(double x, double y, double z, double w);
 
+  void setCoalescing(bool bCoalesce=true);
+  void setMaxRate(double rate);
+
+  void setDynamic(bool bDynamic=true);
+  void setDynamicRate(double rate);
+  void setTolerance(double translation, double angle);
+  /// immediately publish pending changes
+  void flush();
+
 protected:
   void send();
   void check();
 
 private:
-  tf2_ros::StaticTransformBroadcaster broadcaster_;
+  /// @return true if frames changed
+  bool assignFrames(const FrameId &parent_frame, const FrameId &child_frame);
+  void assignPose(const geometry_msgs::Pose &pose);
+  void publish();
+  /// acquire shared registry on first use
+  StaticTransformRegistry &registry();
+  /// does msg_ differ from the last published message?
+  bool changed() const;
+
+private:
+  StaticTransformRegistry::Ptr registry_; // null until first publish
+  FrameId published_child_; // child frame currently published in registry_
+  FrameId published_parent_;
+  // Only the poses of published / streamed messages are kept for change detection:
+  // their frames are tracked as interned FrameIds, the full message lives in registry_.
+  geometry_msgs::Transform published_; // pose last published to registry_
+  FrameId streamed_child_, streamed_parent_; // frames of streamed_, empty if nothing streamed
+  geometry_msgs::Transform streamed_; // pose last streamed to /tf
   geometry_msgs::TransformStamped msg_;
+  FrameId parent_, child_; // frames of msg_
   bool valid_;
   bool enabled_;
+
+  bool coalesce_;
+  bool pending_; // message changed, but not yet published
+  int min_interval_; // minimum interval between publishes in ms
+  QTimer *timer_;
+  QElapsedTimer last_publish_;
+  ros::WallTime pending_since_; // time of first pending request
+  Statistics stats_;
+
+  bool dynamic_;
+  int dynamic_interval_; // minimum interval between dynamic publishes in ms
+
+  double translation_tolerance_;
+  double angle_tolerance_;
 };
@@ -31,6 +31,7 @@
 
 #include "TransformWidget.h"
 #include "EulerWidget.h"
+#include "SignalThrottle.h"
 
 #include "ui_transform.h"
 
@@ -42,6 +43,8 @@ TransformWidget::TransformWidget(QWidget *parent) :
   qRegisterMetaType<Eigen::Quaterniond>("Eigen::Vector3d");
   qRegisterMetaType<Eigen::Quaterniond>("Eigen::Quaterniond");
   pos_.setZero();
+  throttle_ = new SignalThrottle(0, this);
+  connect(throttle_, SIGNAL(triggered()), this, SLOT(emitPosition()));
 
   ui_->setupUi(this);
 
@@ -62,6 +65,17 @@ const Eigen::Quaterniond &TransformWidget::quaternion() const
   return ui_->euler_widget_->value();
 }
 
+int TransformWidget::throttleInterval() const
+{
+  return throttle_->interval();
+}
+
+void TransformWidget::setThrottleInterval(int ms)
+{
+  throttle_->setInterval(ms);
+  ui_->euler_widget_->setThrottleInterval(ms);
+}
+
 void TransformWidget::setPosition(const Eigen::Vector3d &p)
 {
   if (pos_.isApprox(p)) return;
@@ -100,5 +114,11 @@ void TransformWidget::changePos(unsigned int i, double value)
 {
   if (Eigen::internal::isApprox(pos_[i], value)) return;
   pos_[i] = value;
+  // spin box edits are coalesced
+  throttle_->trigger();
+}
+
+void TransformWidget::emitPosition()
+{
   emit positionChanged(pos_);
 }
@@ -37,6 +37,7 @@
 namespace Ui {
 class TransformWidget;
 }
+class SignalThrottle;
 
 /** provide inputs for position + euler angles */
 class TransformWidget : public QWidget
@@ -48,6 +49,10 @@ public:
   const Eigen::Vector3d& position() const;
   const Eigen::Quaterniond& quaternion() const;
 
+  /// minimum interval (ms) between change signals caused by spin box edits, 0 = unlimited
+  int throttleInterval() const;
+  void setThrottleInterval(int ms);
+
 signals:
   void positionChanged(const Eigen::Vector3d &p);
   void quaternionChanged(const Eigen::Quaterniond &q);
@@ -63,8 +68,10 @@ private:
 private slots:
   // update position vector component from sender()
   void changePos(double);
+  void emitPosition();
 
 private:
   Eigen::Vector3d pos_;
+  SignalThrottle *throttle_;
   Ui::TransformWidget *ui_;
 };
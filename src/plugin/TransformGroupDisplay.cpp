@@ -0,0 +1,482 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include "TransformGroupDisplay.h"
+#include "rotation_property.h"
+#include "frame_marker.h"
+#include "BulkConversion.h"
+
+#include <rviz/properties/string_property.h>
+#include <rviz/properties/bool_property.h>
+#include <rviz/properties/float_property.h>
+#include <rviz/properties/vector_property.h>
+#include <rviz/properties/tf_frame_property.h>
+#include <rviz/properties/enum_property.h>
+
+#include <rviz/display_context.h>
+#include <rviz/frame_manager.h>
+#include <rviz/default_plugin/interactive_markers/interactive_marker.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+#include <sstream>
+#include <algorithm>
+
+namespace vm = visualization_msgs;
+static const std::string MARKER_NAME = "marker";
+
+namespace agni_tf_tools
+{
+
+static std::vector<std::string> splitFrames(const std::string &s)
+{
+  std::vector<std::string> result;
+  std::istringstream is(s);
+  std::string frame;
+  while (is >> frame) {
+    if (std::find(result.begin(), result.end(), frame) == result.end())
+      result.push_back(frame);
+  }
+  return result;
+}
+
+int TransformGroupDisplay::PoseStore::find(const std::string &child) const
+{
+  std::map<std::string, int>::const_iterator it = index.find(child);
+  return it == index.end() ? -1 : it->second;
+}
+
+void TransformGroupDisplay::PoseStore::setChildren(const std::vector<std::string> &new_children)
+{
+  const int n = new_children.size();
+  Translations new_translations = Translations::Zero(3, n);
+  Rotations new_rotations(4, n);
+  std::map<std::string, int> new_index;
+  for (int i = 0; i < n; ++i) {
+    const int old = find(new_children[i]);
+    if (old >= 0) {
+      new_translations.col(i) = translations.col(old);
+      new_rotations.col(i) = rotations.col(old);
+    } else
+      new_rotations.col(i) = Eigen::Quaterniond::Identity().coeffs();
+    new_index[new_children[i]] = i;
+  }
+  children = new_children;
+  translations.swap(new_translations);
+  rotations.swap(new_rotations);
+  index.swap(new_index);
+}
+
+
+TransformGroupDisplay::TransformGroupDisplay()
+  : rviz::Display()
+  , marker_node_(0)
+  , marker_update_pending_(false)
+  , ignore_updates_(false)
+  , loading_(false)
+{
+  parent_frame_property_ = new rviz::TfFrameProperty(
+        "parent frame", rviz::TfFrameProperty::FIXED_FRAME_STRING, "", this,
+        0, true, SLOT(onParentFrameChanged()), this);
+  frames_property_ = new rviz::StringProperty(
+        "frames", "", "Whitespace-separated list of child frames to publish", this,
+        SLOT(onFrameListChanged()), this);
+
+  selected_property_ = new rviz::EnumProperty(
+        "selected frame", "", "Child frame to edit via properties and marker", this,
+        SLOT(onSelectionChanged()), this);
+  translation_property_ = new rviz::VectorProperty("translation", Ogre::Vector3::ZERO, "",
+                                                   selected_property_);
+  rotation_property_ = new RotationProperty(selected_property_, "rotation");
+  // pose properties only show the selected frame: all poses are saved in the "Transforms" block
+  translation_property_->setShouldBeSaved(false);
+  rotation_property_->setShouldBeSaved(false);
+
+  broadcast_property_ = new rviz::BoolProperty("publish transforms", true, "", this,
+                                               SLOT(onBroadcastEnableChanged()), this);
+
+  connect(translation_property_, SIGNAL(changed()), this, SLOT(onTransformChanged()));
+  connect(rotation_property_, SIGNAL(quaternionChanged(Eigen::Quaterniond)), this, SLOT(onTransformChanged()));
+  connect(rotation_property_, SIGNAL(statusUpdate(int,QString,QString)),
+          this, SLOT(setStatus(int,QString,QString)));
+
+  marker_property_ = new rviz::EnumProperty("marker type", "interactive frame",
+                                            "Choose which type of interactive marker to show for the selected frame",
+                                            this, SLOT(onMarkerChanged()), this);
+  marker_property_->addOption("none", NONE);
+  marker_property_->addOption("static frame", FRAME);
+  marker_property_->addOption("interactive frame", IFRAME);
+  marker_property_->addOption("6 DoF handles", DOF6);
+  marker_scale_property_ = new rviz::FloatProperty("marker scale", 0.2, "", marker_property_,
+                                                   SLOT(onMarkerChanged()), this);
+  marker_scale_property_->setMin(0.001);
+  // registry_ is acquired on first publish
+}
+
+TransformGroupDisplay::~TransformGroupDisplay()
+{
+  removeAll();
+}
+
+void TransformGroupDisplay::onInitialize()
+{
+  Display::onInitialize();
+  parent_frame_property_->setFrameManager(context_->getFrameManager());
+  marker_node_ = getSceneNode()->createChildSceneNode();
+  this->expand();
+  selected_property_->expand();
+}
+
+void TransformGroupDisplay::load(const rviz::Config &config)
+{
+  loading_ = true;
+  Display::load(config);
+  loading_ = false;
+
+  poses_.setChildren(splitFrames(frames_property_->getStdString()));
+  // one line per frame: child x y z qx qy qz qw
+  QString block;
+  if (config.mapGetString("Transforms", &block)) {
+    std::istringstream is(block.toStdString());
+    std::string line;
+    while (std::getline(is, line)) {
+      std::istringstream ls(line);
+      std::string child;
+      Eigen::Vector3d t;
+      Eigen::Vector4d q;
+      if (!(ls >> child >> t[0] >> t[1] >> t[2] >> q[0] >> q[1] >> q[2] >> q[3]))
+        continue;
+      const int i = poses_.find(child);
+      if (i < 0 || q.norm() < 1e-9) continue;
+      poses_.translations.col(i) = t;
+      poses_.rotations.col(i) = q.normalized();
+    }
+  }
+  onFrameListChanged();
+}
+
+void TransformGroupDisplay::save(rviz::Config config) const
+{
+  Display::save(config);
+  std::ostringstream os;
+  os.precision(17);
+  for (size_t i = 0; i < poses_.size(); ++i) {
+    os << poses_.children[i];
+    for (int k = 0; k < 3; ++k) os << ' ' << poses_.translations(k, i);
+    for (int k = 0; k < 4; ++k) os << ' ' << poses_.rotations(k, i);
+    os << '\n';
+  }
+  config.mapSetValue("Transforms", QString::fromStdString(os.str()));
+}
+
+void TransformGroupDisplay::onEnable()
+{
+  Display::onEnable();
+  publishAll();
+  marker_update_pending_ = true;
+}
+
+void TransformGroupDisplay::onDisable()
+{
+  Display::onDisable();
+  removeAll();
+  imarker_.reset();
+}
+
+void TransformGroupDisplay::update(float wall_dt, float ros_dt)
+{
+  if (!this->isEnabled()) return;
+  Display::update(wall_dt, ros_dt);
+
+  if (marker_update_pending_ && !createMarker())
+    setStatusStd(StatusProperty::Warn, MARKER_NAME, "Waiting for tf");
+  else if (imarker_)
+    imarker_->update(wall_dt); // get online marker updates
+}
+
+
+int TransformGroupDisplay::selected() const
+{
+  return poses_.find(selected_property_->getStdString());
+}
+
+Eigen::Quaterniond TransformGroupDisplay::rotation(int i) const
+{
+  return Eigen::Quaterniond(poses_.rotations.col(i));
+}
+
+geometry_msgs::Pose TransformGroupDisplay::pose(int i) const
+{
+  geometry_msgs::Pose pose;
+  pose.position.x = poses_.translations(0, i);
+  pose.position.y = poses_.translations(1, i);
+  pose.position.z = poses_.translations(2, i);
+  pose.orientation.x = poses_.rotations(0, i);
+  pose.orientation.y = poses_.rotations(1, i);
+  pose.orientation.z = poses_.rotations(2, i);
+  pose.orientation.w = poses_.rotations(3, i);
+  return pose;
+}
+
+geometry_msgs::TransformStamped TransformGroupDisplay::transform(int i) const
+{
+  geometry_msgs::TransformStamped tf;
+  tf.header.stamp = ros::Time::now();
+  tf.header.frame_id = parent_frame_property_->getFrameStd();
+  tf.child_frame_id = poses_.children[i];
+  tf.transform.translation.x = poses_.translations(0, i);
+  tf.transform.translation.y = poses_.translations(1, i);
+  tf.transform.translation.z = poses_.translations(2, i);
+  tf.transform.rotation.x = poses_.rotations(0, i);
+  tf.transform.rotation.y = poses_.rotations(1, i);
+  tf.transform.rotation.z = poses_.rotations(2, i);
+  tf.transform.rotation.w = poses_.rotations(3, i);
+  return tf;
+}
+
+bool TransformGroupDisplay::broadcasting() const
+{
+  return !loading_ && isEnabled() && broadcast_property_->getBool();
+}
+
+void TransformGroupDisplay::publish(int i)
+{
+  if (i < 0 || !broadcasting()) return;
+  if (!registry_) registry_ = StaticTransformRegistry::instance();
+  registry_->update(transform(i), this);
+}
+
+void TransformGroupDisplay::publishAll()
+{
+  if (!broadcasting()) return;
+  if (!registry_) registry_ = StaticTransformRegistry::instance();
+  // withdraw frames that were dropped from the list
+  for (std::vector<std::string>::const_iterator it = published_.begin(); it != published_.end(); ++it)
+    if (poses_.find(*it) < 0)
+      registry_->remove(*it, this);
+  const double *const p[3] = {
+    poses_.translations.row(0).data(), poses_.translations.row(1).data(), poses_.translations.row(2).data()
+  };
+  const double *const q[4] = {
+    poses_.rotations.row(0).data(), poses_.rotations.row(1).data(),
+    poses_.rotations.row(2).data(), poses_.rotations.row(3).data()
+  };
+  euler::toTransforms(p, q, poses_.size(), parent_frame_property_->getFrameStd(),
+                      poses_.children, transforms_);
+  // registry coalesces all updates into a single /tf_static message
+  const ros::Time now = ros::Time::now();
+  for (size_t i = 0; i < transforms_.size(); ++i) {
+    transforms_[i].header.stamp = now;
+    registry_->update(transforms_[i], this);
+  }
+  published_ = poses_.children;
+}
+
+void TransformGroupDisplay::removeAll()
+{
+  for (std::vector<std::string>::const_iterator it = published_.begin(); it != published_.end(); ++it)
+    registry_->remove(*it, this);
+  published_.clear();
+}
+
+bool TransformGroupDisplay::createMarker()
+{
+  marker_update_pending_ = false;
+  const int type = marker_property_->getOptionInt();
+  const int i = selected();
+  if (type == NONE || i < 0) {
+    imarker_.reset();
+    return true;
+  }
+
+  const std::string &parent_frame = parent_frame_property_->getFrameStd();
+  std::string error;
+  if (context_->getFrameManager()->transformHasProblems(parent_frame, ros::Time(), error)) {
+    setStatusStd(StatusProperty::Error, MARKER_NAME, error);
+    marker_update_pending_ = true; // retry in next update()
+    return false;
+  }
+
+  vm::InteractiveMarker im = createMarkerTemplate(type, MARKER_NAME);
+  scaleMarker(im, marker_scale_property_->getFloat());
+  im.header.frame_id = parent_frame;
+  im.header.stamp = ros::Time(); // frame-lock marker
+  im.pose = pose(i);
+
+  if (!imarker_) {
+    imarker_.reset(new rviz::InteractiveMarker(marker_node_, context_));
+    connect(imarker_.get(), SIGNAL(userFeedback(visualization_msgs::InteractiveMarkerFeedback&)),
+            this, SLOT(onMarkerFeedback(visualization_msgs::InteractiveMarkerFeedback&)));
+    connect(imarker_.get(), SIGNAL(statusUpdate(StatusProperty::Level,std::string,std::string)),
+            this, SLOT(setStatusStd(StatusProperty::Level,std::string,std::string)));
+  }
+  setStatusStd(StatusProperty::Ok, MARKER_NAME, "");
+
+  imarker_->processMessage(im);
+  imarker_->setShowVisualAids(false);
+  imarker_->setShowAxes(false);
+  imarker_->setShowDescription(false);
+  return true;
+}
+
+void TransformGroupDisplay::showSelected()
+{
+  const int i = selected();
+  ignore_updates_ = true;
+  if (i >= 0) {
+    const Eigen::Vector3d &t = poses_.translations.col(i);
+    translation_property_->setVector(Ogre::Vector3(t.x(), t.y(), t.z()));
+    rotation_property_->setQuaternion(rotation(i));
+  }
+  translation_property_->setReadOnly(i < 0);
+  rotation_property_->setReadOnly(i < 0);
+  ignore_updates_ = false;
+  marker_update_pending_ = true;
+}
+
+
+void TransformGroupDisplay::setStatus(int level, const QString &name, const QString &text)
+{
+  if (level == rviz::StatusProperty::Ok && text.isEmpty()) {
+    Display::setStatus(static_cast<rviz::StatusProperty::Level>(level), name, text);
+    Display::deleteStatus(name);
+  } else
+    Display::setStatus(static_cast<rviz::StatusProperty::Level>(level), name, text);
+}
+
+void TransformGroupDisplay::setStatusStd(rviz::StatusProperty::Level level,
+                                         const std::string &name, const std::string &text)
+{
+  setStatus(level, QString::fromStdString(name), QString::fromStdString(text));
+}
+
+void TransformGroupDisplay::onParentFrameChanged()
+{
+  if (loading_) return;
+  publishAll();
+  marker_update_pending_ = true;
+}
+
+void TransformGroupDisplay::onFrameListChanged()
+{
+  if (loading_) return;
+  poses_.setChildren(splitFrames(frames_property_->getStdString()));
+
+  // update selectable frames, keeping current selection if possible
+  const std::string current = selected_property_->getStdString();
+  selected_property_->clearOptions();
+  for (size_t i = 0; i < poses_.size(); ++i)
+    selected_property_->addOptionStd(poses_.children[i], i);
+  if (poses_.find(current) < 0)
+    selected_property_->setStdString(poses_.size() ? poses_.children.front() : std::string());
+
+  publishAll();
+  showSelected();
+}
+
+void TransformGroupDisplay::onSelectionChanged()
+{
+  if (loading_) return;
+  showSelected();
+}
+
+void TransformGroupDisplay::onTransformChanged()
+{
+  if (ignore_updates_ || loading_) return;
+  const int i = selected();
+  if (i < 0) return;
+
+  const Ogre::Vector3 &p = translation_property_->getVector();
+  poses_.translations.col(i) = Eigen::Vector3d(p.x, p.y, p.z);
+  poses_.rotations.col(i) = rotation_property_->getQuaternion().coeffs();
+  publish(i);
+
+  if (imarker_) {
+    vm::InteractiveMarkerPose marker_pose;
+    marker_pose.header.frame_id = parent_frame_property_->getFrameStd();
+    marker_pose.pose = pose(i);
+    ignore_updates_ = true;
+    imarker_->processMessage(marker_pose);
+    ignore_updates_ = false;
+  }
+}
+
+void TransformGroupDisplay::onMarkerFeedback(vm::InteractiveMarkerFeedback &feedback)
+{
+  if (ignore_updates_ || feedback.event_type != vm::InteractiveMarkerFeedback::POSE_UPDATE)
+    return;
+  const int i = selected();
+  if (i < 0) return;
+
+  // convert to parent frame
+  const std::string &parent_frame = parent_frame_property_->getFrameStd();
+  geometry_msgs::PoseStamped pose_in, pose_out;
+  pose_in.header = feedback.header;
+  pose_in.pose = feedback.pose;
+  if (feedback.header.frame_id == parent_frame)
+    pose_out = pose_in;
+  else try {
+    const geometry_msgs::TransformStamped tf =
+        context_->getFrameManager()->getTF2BufferPtr()->lookupTransform(
+          parent_frame, feedback.header.frame_id, feedback.header.stamp);
+    tf2::doTransform(pose_in, pose_out, tf);
+  } catch(const tf2::TransformException &e) {
+    ROS_DEBUG("Error transforming from frame '%s' to frame '%s': %s",
+              feedback.header.frame_id.c_str(), parent_frame.c_str(), e.what());
+    return;
+  }
+
+  const geometry_msgs::Point &p = pose_out.pose.position;
+  const geometry_msgs::Quaternion &q = pose_out.pose.orientation;
+  poses_.translations.col(i) = Eigen::Vector3d(p.x, p.y, p.z);
+  poses_.rotations.col(i) = Eigen::Quaterniond(q.w, q.x, q.y, q.z).normalized().coeffs();
+
+  ignore_updates_ = true;
+  translation_property_->setVector(Ogre::Vector3(p.x, p.y, p.z));
+  rotation_property_->setQuaternion(rotation(i));
+  ignore_updates_ = false;
+  publish(i);
+}
+
+void TransformGroupDisplay::onBroadcastEnableChanged()
+{
+  if (broadcast_property_->getBool())
+    publishAll();
+  else
+    removeAll();
+}
+
+void TransformGroupDisplay::onMarkerChanged()
+{
+  // defer marker update to next update() cycle
+  marker_update_pending_ = true;
+}
+
+} // namespace agni_tf_tools
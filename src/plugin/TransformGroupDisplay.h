@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#pragma once
+
+#include <rviz/display.h>
+#include <visualization_msgs/InteractiveMarkerFeedback.h>
+#include <geometry_msgs/TransformStamped.h>
+#include <Eigen/Geometry>
+#include <boost/shared_ptr.hpp>
+#include <map>
+
+#include "StaticTransformRegistry.h"
+
+// forward declarations of classes
+namespace rviz
+{
+class StringProperty;
+class BoolProperty;
+class FloatProperty;
+class VectorProperty;
+class TfFrameProperty;
+class EnumProperty;
+
+class InteractiveMarker;
+}
+
+namespace agni_tf_tools
+{
+// needed because rviz::InteractiveMarker::statusUpdate is declared without rviz namespace
+using rviz::StatusProperty;
+
+class RotationProperty;
+
+/** Publish the static transforms of several child frames w.r.t. a common parent frame
+ *
+ *  All poses are kept in a contiguous structure-of-arrays store and
+ *  published in one batch via the StaticTransformRegistry.
+ *  Only the selected frame is exposed for editing via properties and a single
+ *  interactive marker. Hence, memory and update() costs don't grow with the number of frames.
+ */
+class TransformGroupDisplay : public rviz::Display
+{
+  Q_OBJECT
+
+public:
+  TransformGroupDisplay();
+  ~TransformGroupDisplay();
+
+  /// load config, reading all poses from a compact "Transforms" block
+  void load(const rviz::Config &config);
+  void save(rviz::Config config) const;
+
+protected:
+  void onInitialize();
+  void onEnable();
+  void onDisable();
+  void update(float wall_dt, float ros_dt);
+
+protected Q_SLOTS:
+  void setStatus(int level, const QString &name, const QString &text);
+  void setStatusStd(StatusProperty::Level, const std::string &name, const std::string &text);
+  void onParentFrameChanged();
+  void onFrameListChanged();
+  void onSelectionChanged();
+  void onTransformChanged();
+  void onMarkerFeedback(visualization_msgs::InteractiveMarkerFeedback &feedback);
+  void onBroadcastEnableChanged();
+  void onMarkerChanged();
+
+private:
+  /// structure-of-arrays store of all child frame poses w.r.t. the parent frame
+  struct PoseStore {
+    // row-major: each component is contiguous, as required by euler::toTransforms()
+    typedef Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::RowMajor> Translations;
+    typedef Eigen::Matrix<double, 4, Eigen::Dynamic, Eigen::RowMajor> Rotations;
+
+    std::vector<std::string> children;
+    Translations translations;
+    Rotations rotations; // quaternion coefficients (x,y,z,w)
+    std::map<std::string, int> index; // child frame -> column
+
+    size_t size() const { return children.size(); }
+    int find(const std::string &child) const;
+    /// set new list of children, keeping the poses of existing ones
+    void setChildren(const std::vector<std::string> &new_children);
+  };
+
+  int selected() const;
+  Eigen::Quaterniond rotation(int i) const;
+  geometry_msgs::Pose pose(int i) const;
+  geometry_msgs::TransformStamped transform(int i) const;
+  bool broadcasting() const;
+  void publish(int i);
+  /// publish all frames, withdrawing those dropped from the list
+  void publishAll();
+  /// withdraw all published frames
+  void removeAll();
+  /// show pose of selected frame in properties and marker
+  void showSelected();
+  bool createMarker();
+
+  // properties
+  rviz::TfFrameProperty *parent_frame_property_;
+  rviz::StringProperty *frames_property_;
+  rviz::EnumProperty *selected_property_;
+  rviz::VectorProperty *translation_property_;
+  RotationProperty *rotation_property_;
+  rviz::BoolProperty *broadcast_property_;
+  rviz::EnumProperty *marker_property_;
+  rviz::FloatProperty *marker_scale_property_;
+
+  PoseStore poses_;
+  std::vector<std::string> published_; // children currently published in registry_
+  std::vector<geometry_msgs::TransformStamped> transforms_; // reused by publishAll()
+  StaticTransformRegistry::Ptr registry_; // null until first publish
+
+  // interactive marker of selected frame
+  boost::shared_ptr<rviz::InteractiveMarker> imarker_;
+  Ogre::SceneNode *marker_node_;
+  bool marker_update_pending_; // marker needs to be rebuilt in next update()
+  bool ignore_updates_;
+  bool loading_; // within load(): defer reactions to property changes
+};
+
+} // namespace agni_tf_tools
@@ -32,6 +32,7 @@
 #include "TransformPublisherDisplay.h"
 #include "TransformBroadcaster.h"
 #include "rotation_property.h"
+#include "frame_marker.h"
 
 #include <rviz/properties/string_property.h>
 #include <rviz/properties/bool_property.h>
@@ -44,14 +45,18 @@
 #include <rviz/display_context.h>
 #include <rviz/frame_manager.h>
 #include <rviz/default_plugin/interactive_markers/interactive_marker.h>
-#include <interactive_markers/tools.h>
-#include <tf/transform_listener.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <boost/bind.hpp>
 #include <QDebug>
+#include <algorithm>
 
 namespace vm = visualization_msgs;
 const std::string MARKER_NAME = "marker";
-
-enum MARKER_TYPE { NONE, FRAME, IFRAME, DOF6 };
+// exponential back-off of marker creation attempts while tf is missing
+const float MIN_RETRY_DELAY = 0.1;
+const float MAX_RETRY_DELAY = 5.0;
 
 namespace agni_tf_tools
 {
@@ -73,8 +78,23 @@ void static updatePose(geometry_msgs::Pose &pose,
 
 TransformPublisherDisplay::TransformPublisherDisplay()
   : rviz::Display()
+  , marker_update_pending_(false)
+  , marker_refresh_pending_(false)
+  , dragging_(false)
+  , retry_delay_(MIN_RETRY_DELAY)
+  , retry_elapsed_(MAX_RETRY_DELAY)
+  , tf_callback_(0)
+  , tf_request_(0)
+  , tf_ready_(false)
   , ignore_updates_(false)
+  , loading_(false)
+  , status_time_(0)
+  , notifications_(0)
+  , publishes_(0)
+  , dynamic_publishes_(0)
+  , tf_changed_(false)
 {
+  frame_cache_.valid = false;
   translation_property_ = new rviz::VectorProperty("translation", Ogre::Vector3::ZERO, "", this);
   rotation_property_ = new RotationProperty(this, "rotation");
 
@@ -93,12 +113,35 @@ TransformPublisherDisplay::TransformPublisherDisplay()
   child_frame_property_ = new rviz::TfFrameProperty(
         "child frame", "", "", broadcast_property_,
         0, false, SLOT(onFramesChanged()), this);
+  max_rate_property_ = new rviz::FloatProperty(
+        "max rate", 0, "Maximum publishing rate in Hz (0: once per update cycle)",
+        broadcast_property_, SLOT(onMaxRateChanged()), this);
+  max_rate_property_->setMin(0);
+  dynamic_property_ = new rviz::BoolProperty(
+        "dynamic while dragging", false,
+        "Stream the transform to /tf while dragging the marker "
+        "and only publish the final pose to /tf_static.",
+        broadcast_property_, SLOT(onDynamicChanged()), this);
+  dynamic_rate_property_ = new rviz::FloatProperty(
+        "dynamic rate", 30, "Maximum rate in Hz for streaming to /tf while dragging",
+        dynamic_property_, SLOT(onDynamicChanged()), this);
+  dynamic_rate_property_->setMin(0);
+  translation_tolerance_property_ = new rviz::FloatProperty(
+        "translation tolerance", 1e-6, "Ignore translation changes below this distance (m)",
+        broadcast_property_, SLOT(onToleranceChanged()), this);
+  translation_tolerance_property_->setMin(0);
+  angle_tolerance_property_ = new rviz::FloatProperty(
+        "angle tolerance", 1e-4, "Ignore rotation changes below this angle (deg)",
+        broadcast_property_, SLOT(onToleranceChanged()), this);
+  angle_tolerance_property_->setMin(0);
 
   connect(translation_property_, SIGNAL(changed()), this, SLOT(onTransformChanged()));
   connect(rotation_property_, SIGNAL(quaternionChanged(Eigen::Quaterniond)), this, SLOT(onTransformChanged()));
   connect(rotation_property_, SIGNAL(statusUpdate(int,QString,QString)),
           this, SLOT(setStatus(int,QString,QString)));
   tf_pub_ = new TransformBroadcaster("", "", this);
+  tf_pub_->setEnabled(false); // displays start disabled: don't publish before onEnable()
+  onToleranceChanged();
 
   marker_property_ = new rviz::EnumProperty("marker type", "interactive frame", "Choose which type of interactive marker to show",
                                             this, SLOT(onMarkerTypeChanged()), this);
@@ -110,10 +153,23 @@ TransformPublisherDisplay::TransformPublisherDisplay()
   marker_scale_property_ = new rviz::FloatProperty("marker scale", 0.2, "", marker_property_,
                                                    SLOT(onMarkerScaleChanged()), this);
   marker_property_->hide(); // only show when marker is created
+
+  statistics_property_ = new rviz::BoolProperty(
+        "statistics", true, "Show publishing and timing statistics in status", this,
+        SLOT(onStatisticsChanged()), this);
+  diagnostics_property_ = new rviz::BoolProperty(
+        "publish diagnostics", false, "Publish statistics to /diagnostics", statistics_property_,
+        SLOT(onStatisticsChanged()), this);
 }
 
 TransformPublisherDisplay::~TransformPublisherDisplay()
 {
+  if (tf_request_)
+    context_->getFrameManager()->getTF2BufferPtr()->cancelTransformableRequest(tf_request_);
+  if (tf_callback_)
+    context_->getFrameManager()->getTF2BufferPtr()->removeTransformableCallback(tf_callback_);
+  if (tf_changed_connection_.connected())
+    context_->getFrameManager()->getTF2BufferPtr()->_removeTransformsChangedListener(tf_changed_connection_);
 }
 
 void TransformPublisherDisplay::onInitialize()
@@ -121,7 +177,13 @@ void TransformPublisherDisplay::onInitialize()
   Display::onInitialize();
   parent_frame_property_->setFrameManager(context_->getFrameManager());
   child_frame_property_->setFrameManager(context_->getFrameManager());
+  fixed_frame_id_ = FrameId(fixed_frame_);
+  updateFrameIds();
   marker_node_ = getSceneNode()->createChildSceneNode();
+  tf_changed_connection_ = context_->getFrameManager()->getTF2BufferPtr()->_addTransformsChangedListener(
+                             boost::bind(&TransformPublisherDisplay::onTransformsChanged, this));
+  tf_callback_ = context_->getFrameManager()->getTF2BufferPtr()->addTransformableCallback(
+                   boost::bind(&TransformPublisherDisplay::onTransformable, this));
 
   // show some children by default
   this->expand();
@@ -133,107 +195,162 @@ void TransformPublisherDisplay::reset()
   Display::reset();
 }
 
+void TransformPublisherDisplay::load(const rviz::Config &config)
+{
+  // Loading individual properties would trigger a cascade of marker updates and
+  // broadcasts. Instead apply the final frames and pose once.
+  loading_ = true;
+  Display::load(config);
+  loading_ = false;
+
+  updateFrameIds();
+  onAdaptTransformChanged();
+  onFramesChanged();
+  marker_update_pending_ = true; // (re)create marker in next update()
+}
+
 void TransformPublisherDisplay::onEnable()
 {
   Display::onEnable();
-  tf_pub_->setEnabled(true);
+  onBroadcastEnableChanged();
 }
 
 void TransformPublisherDisplay::onDisable()
 {
   Display::onDisable();
   tf_pub_->setEnabled(false);
+  dragging_ = false;
+  cancelTransformable();
   createInteractiveMarker(NONE);
 }
 
 void TransformPublisherDisplay::update(float wall_dt, float ros_dt)
 {
   if (!this->isEnabled()) return;
+  const ros::WallTime start = ros::WallTime::now();
 
   Display::update(wall_dt, ros_dt);
-  // create marker if not yet done
-  if (!imarker_ && marker_property_->getOptionInt() != NONE &&
-      !createInteractiveMarker(marker_property_->getOptionInt()))
-    setStatusStd(StatusProperty::Warn, MARKER_NAME, "Waiting for tf");
-  else if (imarker_)
-    imarker_->update(wall_dt); // get online marker updates
-}
+  updateStatistics(wall_dt);
 
+  // invalidate cached frame transforms once per update cycle at most
+  const bool tf_changed = tf_changed_.exchange(false);
+  if (tf_changed) {
+    frame_cache_.valid = false;
+    marker_refresh_pending_ = true; // frame-locked marker needs to follow
+  }
 
-static vm::Marker createArrowMarker(double scale,
-                                    const Eigen::Vector3d &dir,
-                                    const QColor &color) {
-  vm::Marker marker;
-
-  marker.type = vm::Marker::ARROW;
-  marker.scale.x = scale;
-  marker.scale.y = 0.1*scale;
-  marker.scale.z = 0.1*scale;
+  // apply deferred marker changes, create marker if not yet done
+  if (marker_update_pending_) {
+    marker_update_pending_ = false;
+    if (imarker_) createInteractiveMarker(marker_property_->getOptionInt());
+  }
+  if (!imarker_ && marker_property_->getOptionInt() != NONE) {
+    // While a readiness request is pending, tf signals availability of the parent frame:
+    // don't touch tf at all. Otherwise retry on tf changes or after back-off delay,
+    // but not more often than MIN_RETRY_DELAY.
+    retry_elapsed_ += wall_dt;
+    const bool ready = tf_ready_.exchange(false);
+    if (ready || (!tf_request_ && (retry_elapsed_ >= retry_delay_ ||
+                                   (tf_changed && retry_elapsed_ >= MIN_RETRY_DELAY)))) {
+      tf_request_ = 0; // answered requests are removed by tf
+      retry_elapsed_ = 0;
+      if (createInteractiveMarker(marker_property_->getOptionInt()))
+        retry_delay_ = MIN_RETRY_DELAY;
+      else {
+        retry_delay_ = std::min(2 * retry_delay_, MAX_RETRY_DELAY);
+        setStatusStd(StatusProperty::Warn, MARKER_NAME, "Waiting for tf");
+        requestTransformable();
+      }
+    }
+  } else if (imarker_ && (dragging_ || marker_refresh_pending_)) {
+    // idle marker doesn't need updates: only while dragging or for pending frame changes
+    marker_refresh_pending_ = false;
+    imarker_->update(wall_dt);
+  }
 
-  updatePose(marker.pose,
-             Eigen::Quaterniond::FromTwoVectors(Eigen::Vector3d::UnitX(), dir));
+  update_time_.add((ros::WallTime::now() - start).toSec());
+}
 
-  marker.color.r = color.redF();
-  marker.color.g = color.greenF();
-  marker.color.b = color.blueF();
-  marker.color.a = color.alphaF();
+static const char* STATISTICS_ENTRIES[] = {
+  "Publishing", "Publish latency", "update()", "Marker feedback", "tf lookup"
+};
 
-  return marker;
+void TransformPublisherDisplay::onStatisticsChanged()
+{
+  if (!statistics_property_->getBool()) {
+    for (size_t i = 0; i < sizeof(STATISTICS_ENTRIES) / sizeof(STATISTICS_ENTRIES[0]); ++i)
+      deleteStatus(STATISTICS_ENTRIES[i]);
+  }
+  if (diagnostics_property_->getBool() && statistics_property_->getBool()) {
+    if (!diagnostics_pub_)
+      diagnostics_pub_ = ros::NodeHandle().advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+  } else
+    diagnostics_pub_.shutdown();
 }
 
-inline void setOrientation(geometry_msgs::Quaternion &q, double w, double x, double y, double z) {
-  q.w = w;
-  q.x = x;
-  q.y = y;
-  q.z = z;
+static void addValue(diagnostic_msgs::DiagnosticStatus &status,
+                     const std::string &key, const std::string &value)
+{
+  diagnostic_msgs::KeyValue kv;
+  kv.key = key;
+  kv.value = value;
+  status.values.push_back(kv);
 }
 
-void TransformPublisherDisplay::addFrameControls(vm::InteractiveMarker &im, double scale, bool interactive)
+void TransformPublisherDisplay::updateStatistics(float wall_dt)
 {
-  vm::InteractiveMarkerControl ctrl;
-  setOrientation(ctrl.orientation, 1, 0,0,0);
-  ctrl.always_visible = true;
-  if (interactive) {
-    ctrl.orientation_mode = vm::InteractiveMarkerControl::VIEW_FACING;
-    ctrl.independent_marker_orientation = true;
-    ctrl.interaction_mode = vm::InteractiveMarkerControl::MOVE_ROTATE_3D;
+  // refresh at most once per second
+  status_time_ += wall_dt;
+  if (status_time_ < 1.0) return;
+  const float elapsed = status_time_;
+  status_time_ = 0;
+
+  // report property notification fan-out
+  if (notifications_ != rotation_property_->notifications()) {
+    notifications_ = rotation_property_->notifications();
+    setStatus(StatusProperty::Ok, "Notifications",
+              QString("%1 rotation property notifications").arg(notifications_));
   }
-  ctrl.name = "frame";
-
-  ctrl.markers.push_back(createArrowMarker(im.scale * scale, Eigen::Vector3d::UnitX(), QColor("red")));
-  ctrl.markers.push_back(createArrowMarker(im.scale * scale, Eigen::Vector3d::UnitY(), QColor("green")));
-  ctrl.markers.push_back(createArrowMarker(im.scale * scale, Eigen::Vector3d::UnitZ(), QColor("blue")));
-
-  im.controls.push_back(ctrl);
+  if (!statistics_property_->getBool()) return;
+
+  const TransformBroadcaster::Statistics &stats = tf_pub_->statistics();
+  const QString publishing = QString("%1 Hz static, %2 Hz dynamic, %3 rejected, %4 coalesced, %5 duplicates")
+      .arg((stats.publishes - publishes_) / elapsed, 0, 'f', 1)
+      .arg((stats.dynamic_publishes - dynamic_publishes_) / elapsed, 0, 'f', 1)
+      .arg(stats.rejected).arg(stats.coalesced).arg(stats.duplicates);
+  publishes_ = stats.publishes;
+  dynamic_publishes_ = stats.dynamic_publishes;
+
+  const std::string summaries[] = {
+    publishing.toStdString(),
+    stats.latency.summary(),
+    update_time_.summary(),
+    feedback_time_.summary(),
+    lookup_time_.summary()
+  };
+  for (size_t i = 0; i < sizeof(STATISTICS_ENTRIES) / sizeof(STATISTICS_ENTRIES[0]); ++i)
+    setStatus(StatusProperty::Ok, STATISTICS_ENTRIES[i], QString::fromStdString(summaries[i]));
+
+  if (!diagnostics_pub_) return;
+  diagnostic_msgs::DiagnosticArray array;
+  array.header.stamp = ros::Time::now();
+  array.status.resize(1);
+  diagnostic_msgs::DiagnosticStatus &status = array.status.front();
+  status.level = diagnostic_msgs::DiagnosticStatus::OK;
+  status.name = "agni_tf_tools: " + getName().toStdString();
+  status.message = child_frame_id_.str();
+  for (size_t i = 0; i < sizeof(STATISTICS_ENTRIES) / sizeof(STATISTICS_ENTRIES[0]); ++i)
+    addValue(status, STATISTICS_ENTRIES[i], summaries[i]);
+  diagnostics_pub_.publish(array);
 }
 
-void TransformPublisherDisplay::add6DOFControls(vm::InteractiveMarker &im) {
-  vm::InteractiveMarkerControl ctrl;
-  ctrl.always_visible = false;
-
-  setOrientation(ctrl.orientation, 1, 1,0,0);
-  ctrl.interaction_mode = vm::InteractiveMarkerControl::MOVE_AXIS;
-  ctrl.name = "x pos";
-  im.controls.push_back(ctrl);
-  ctrl.interaction_mode = vm::InteractiveMarkerControl::ROTATE_AXIS;
-  ctrl.name = "x rot";
-  im.controls.push_back(ctrl);
-
-  setOrientation(ctrl.orientation, 1, 0,1,0);
-  ctrl.interaction_mode = vm::InteractiveMarkerControl::MOVE_AXIS;
-  ctrl.name = "y pos";
-  im.controls.push_back(ctrl);
-  ctrl.interaction_mode = vm::InteractiveMarkerControl::ROTATE_AXIS;
-  ctrl.name = "y rot";
-  im.controls.push_back(ctrl);
 
-  setOrientation(ctrl.orientation, 1, 0,0,1);
-  ctrl.interaction_mode = vm::InteractiveMarkerControl::MOVE_AXIS;
-  ctrl.name = "z pos";
-  im.controls.push_back(ctrl);
-  ctrl.interaction_mode = vm::InteractiveMarkerControl::ROTATE_AXIS;
-  ctrl.name = "z rot";
-  im.controls.push_back(ctrl);
+const vm::InteractiveMarker &TransformPublisherDisplay::markerTemplate(int type)
+{
+  std::map<int, vm::InteractiveMarker>::iterator it = marker_templates_.find(type);
+  if (it == marker_templates_.end())
+    it = marker_templates_.insert(std::make_pair(type, createMarkerTemplate(type, MARKER_NAME))).first;
+  return it->second;
 }
 
 bool TransformPublisherDisplay::createInteractiveMarker(int type)
@@ -244,47 +361,113 @@ bool TransformPublisherDisplay::createInteractiveMarker(int type)
     return true;
   }
 
-  float scale = marker_scale_property_->getFloat();
-
-  vm::InteractiveMarker im;
-  im.name = MARKER_NAME;
-  im.scale = scale;
+  vm::InteractiveMarker im = markerTemplate(type);
+  scaleMarker(im, marker_scale_property_->getFloat());
   if (!fillPoseStamped(im.header, im.pose)) return false;
 
-  if (type == FRAME || type == IFRAME)
-    addFrameControls(im, 1.0, type == IFRAME);
-  else if (type == DOF6) {
-    addFrameControls(im, 0.5, type == IFRAME);
-    add6DOFControls(im);
+  // reuse existing marker: processMessage() only updates changed controls
+  if (!imarker_) {
+    imarker_.reset(new rviz::InteractiveMarker(marker_node_, context_));
+    connect(imarker_.get(), SIGNAL(userFeedback(visualization_msgs::InteractiveMarkerFeedback&)),
+            this, SLOT(onMarkerFeedback(visualization_msgs::InteractiveMarkerFeedback&)));
+    connect(imarker_.get(), SIGNAL(statusUpdate(StatusProperty::Level,std::string,std::string)),
+            this, SLOT(setStatusStd(StatusProperty::Level,std::string,std::string)));
   }
 
-  imarker_.reset(new rviz::InteractiveMarker(marker_node_, context_));
-  connect(imarker_.get(), SIGNAL(userFeedback(visualization_msgs::InteractiveMarkerFeedback&)),
-          this, SLOT(onMarkerFeedback(visualization_msgs::InteractiveMarkerFeedback&)));
-  connect(imarker_.get(), SIGNAL(statusUpdate(StatusProperty::Level,std::string,std::string)),
-          this, SLOT(setStatusStd(StatusProperty::Level,std::string,std::string)));
-
   setStatusStd(rviz::StatusProperty::Ok, MARKER_NAME, "Ok");
 
-  // fill in default controls
-  interactive_markers::autoComplete(im, true);
-
   imarker_->processMessage(im);
   imarker_->setShowVisualAids(false);
   imarker_->setShowAxes(false);
   imarker_->setShowDescription(false);
 
   marker_property_->show();
+  marker_refresh_pending_ = true;
   return true;
 }
 
 
+void TransformPublisherDisplay::fixedFrameChanged()
+{
+  frame_cache_.valid = false;
+  fixed_frame_id_ = FrameId(fixed_frame_);
+  cancelTransformable(); // pending request refers to previous fixed frame
+  updateFrameIds(); // frame properties might refer to the fixed frame
+  marker_refresh_pending_ = true;
+}
+
+void TransformPublisherDisplay::onTransformsChanged()
+{
+  // called from tf thread: only flag change to be handled in update()
+  tf_changed_ = true;
+}
+
+void TransformPublisherDisplay::onTransformable()
+{
+  // called from tf thread (with tf's request lock held): only flag readiness
+  tf_ready_ = true;
+}
+
+void TransformPublisherDisplay::requestTransformable()
+{
+  if (tf_request_ || !tf_callback_) return;
+  tf_ready_ = false;
+  tf2::TransformableRequestHandle handle =
+      context_->getFrameManager()->getTF2BufferPtr()->addTransformableRequest(
+        tf_callback_, fixed_frame_id_.str(), parent_frame_id_.str(), ros::Time());
+  // 0: already transformable, ~0: never transformable. Both fall back to back-off retries.
+  if (handle != 0 && handle != 0xffffffffffffffffULL)
+    tf_request_ = handle;
+}
+
+void TransformPublisherDisplay::cancelTransformable()
+{
+  if (tf_request_)
+    context_->getFrameManager()->getTF2BufferPtr()->cancelTransformableRequest(tf_request_);
+  tf_request_ = 0;
+  tf_ready_ = false;
+  retry_delay_ = MIN_RETRY_DELAY; // retry immediately with new frames
+  retry_elapsed_ = MAX_RETRY_DELAY;
+}
+
+static bool getTransform(rviz::FrameManager &fm, const std::string &frame, Eigen::Affine3d &tf)
+{
+  Ogre::Vector3 p = Ogre::Vector3::ZERO;
+  Ogre::Quaternion q = Ogre::Quaternion::IDENTITY;
+
+  bool success = fm.getTransform(frame, ros::Time(), p, q);
+  tf = Eigen::Translation3d(p.x, p.y, p.z) * Eigen::Quaterniond(q.w, q.x, q.y, q.z);
+  return success || frame == rviz::TfFrameProperty::FIXED_FRAME_STRING.toStdString();
+}
+
+bool TransformPublisherDisplay::lookupFrame(const FrameId &frame, Eigen::Affine3d &tf,
+                                            std::string *error)
+{
+  FrameCache &c = frame_cache_;
+  if (!c.valid || c.frame != frame) {
+    const ros::WallTime start = ros::WallTime::now();
+    rviz::FrameManager &fm = *context_->getFrameManager();
+    c.frame = frame;
+    c.error.clear();
+    c.has_problems = fm.transformHasProblems(frame.str(), ros::Time(), c.error);
+    c.available = getTransform(fm, frame.str(), c.tf);
+    c.valid = true;
+    lookup_time_.add((ros::WallTime::now() - start).toSec());
+  }
+  tf = c.tf;
+  if (error) {
+    *error = c.error;
+    return !c.has_problems;
+  }
+  return c.available;
+}
+
 bool TransformPublisherDisplay::fillPoseStamped(std_msgs::Header &header,
                                                 geometry_msgs::Pose &pose)
 {
-  const std::string &parent_frame = parent_frame_property_->getFrameStd();
   std::string error;
-  if (context_->getFrameManager()->transformHasProblems(parent_frame, ros::Time(), error))
+  Eigen::Affine3d tf;
+  if (!lookupFrame(parent_frame_id_, tf, &error))
   {
     setStatusStd(StatusProperty::Error, MARKER_NAME, error);
     return false;
@@ -294,7 +477,8 @@ bool TransformPublisherDisplay::fillPoseStamped(std_msgs::Header &header,
   const Eigen::Quaterniond &q = rotation_property_->getQuaternion();
   const Ogre::Vector3 &p = translation_property_->getVector();
   updatePose(pose, q, p);
-  header.frame_id = parent_frame;
+  if (header.frame_id != parent_frame_id_.str())
+    header.frame_id = parent_frame_id_.str();
   // frame-lock marker to update marker pose with frame updates
   header.stamp = ros::Time();
   return true;
@@ -315,23 +499,14 @@ void TransformPublisherDisplay::setStatusStd(rviz::StatusProperty::Level level,
   setStatus(level, QString::fromStdString(name), QString::fromStdString(text));
 }
 
-static bool getTransform(rviz::FrameManager &fm, const std::string &frame, Eigen::Affine3d &tf)
-{
-  Ogre::Vector3 p = Ogre::Vector3::ZERO;
-  Ogre::Quaternion q = Ogre::Quaternion::IDENTITY;
-
-  bool success = fm.getTransform(frame, ros::Time(), p, q);
-  tf = Eigen::Translation3d(p.x, p.y, p.z) * Eigen::Quaterniond(q.w, q.x, q.y, q.z);
-  return success || frame == rviz::TfFrameProperty::FIXED_FRAME_STRING.toStdString();
-}
-
 void TransformPublisherDisplay::onRefFrameChanged()
 {
+  if (loading_) return;
   // update pose to be relative to new reference frame
   Eigen::Affine3d prevRef, nextRef;
-  rviz::FrameManager &fm = *context_->getFrameManager();
-  if (getTransform(fm, prev_parent_frame_, prevRef) &&
-      getTransform(fm, parent_frame_property_->getFrameStd(), nextRef)) {
+  updateFrameIds();
+  if (lookupFrame(prev_parent_frame_, prevRef) &&
+      lookupFrame(parent_frame_id_, nextRef)) {
     const Ogre::Vector3 &p = translation_property_->getVector();
     Eigen::Affine3d curPose = Eigen::Translation3d(p.x, p.y, p.z) * rotation_property_->getQuaternion();
     Eigen::Affine3d newPose = nextRef.inverse() * prevRef * curPose;
@@ -348,87 +523,140 @@ void TransformPublisherDisplay::onRefFrameChanged()
 void TransformPublisherDisplay::onAdaptTransformChanged()
 {
   if (adapt_transform_property_->getBool())
-    prev_parent_frame_ = parent_frame_property_->getFrameStd();
+    prev_parent_frame_ = parent_frame_id_;
   else
-    prev_parent_frame_ = "";
+    prev_parent_frame_ = FrameId();
 }
 
 void TransformPublisherDisplay::onFramesChanged()
 {
+  if (loading_) return;
+  updateFrameIds();
   // update marker pose
-  vm::InteractiveMarkerPose marker_pose;
-  fillPoseStamped(marker_pose.header, marker_pose.pose);
-  if (imarker_) imarker_->processMessage(marker_pose);
+  fillPoseStamped(marker_pose_.header, marker_pose_.pose);
+  if (imarker_) imarker_->processMessage(marker_pose_);
+  marker_refresh_pending_ = true;
 
-  // prepare transform for broadcasting
-  geometry_msgs::TransformStamped tf;
-  tf.header.frame_id = parent_frame_property_->getFrameStd();
-  tf.child_frame_id = child_frame_property_->getFrameStd();
-  tf.transform.translation.x = marker_pose.pose.position.x;
-  tf.transform.translation.y = marker_pose.pose.position.y;
-  tf.transform.translation.z = marker_pose.pose.position.z;
-  tf.transform.rotation = marker_pose.pose.orientation;
-  tf_pub_->setValue(tf);
+  // broadcast: message strings are only rebuilt if frames changed
+  tf_pub_->setValue(parent_frame_id_, child_frame_id_, marker_pose_.pose);
+}
+
+void TransformPublisherDisplay::updateFrameIds()
+{
+  const FrameId parent(parent_frame_property_->getFrame());
+  if (parent != parent_frame_id_) cancelTransformable(); // request refers to previous parent
+  parent_frame_id_ = parent;
+  child_frame_id_ = FrameId(child_frame_property_->getFrame());
 }
 
 void TransformPublisherDisplay::onTransformChanged()
 {
-  if (ignore_updates_) return;
+  if (ignore_updates_ || loading_) return;
 
-  vm::InteractiveMarkerPose marker_pose;
-  fillPoseStamped(marker_pose.header, marker_pose.pose);
+  fillPoseStamped(marker_pose_.header, marker_pose_.pose);
 
   // update marker pose + broadcast pose
   ignore_updates_ = true;
-  if (imarker_) imarker_->processMessage(marker_pose);
+  if (imarker_) imarker_->processMessage(marker_pose_);
   ignore_updates_ = false;
-  tf_pub_->setPose(marker_pose.pose);
+  marker_refresh_pending_ = true;
+  tf_pub_->setPose(marker_pose_.pose);
 }
 
 void TransformPublisherDisplay::onMarkerFeedback(vm::InteractiveMarkerFeedback &feedback)
 {
   if (ignore_updates_) return;
-  if (feedback.event_type != vm::InteractiveMarkerFeedback::POSE_UPDATE) return;
+  switch (feedback.event_type) {
+  case vm::InteractiveMarkerFeedback::MOUSE_DOWN:
+    dragging_ = true;
+    tf_pub_->setDynamic(dynamic_property_->getBool());
+    return;
+  case vm::InteractiveMarkerFeedback::MOUSE_UP:
+    dragging_ = false;
+    marker_refresh_pending_ = true; // publish final pose
+    tf_pub_->setDynamic(false); // commit final pose to /tf_static
+    return;
+  case vm::InteractiveMarkerFeedback::POSE_UPDATE:
+    break;
+  default:
+    return;
+  }
+  const ros::WallTime start = ros::WallTime::now();
 
   // convert to parent frame
+  const std::string &parent_frame = parent_frame_id_.str();
   const geometry_msgs::Point &p_in = feedback.pose.position;
   const geometry_msgs::Quaternion &q_in = feedback.pose.orientation;
-
-  tf::Stamped<tf::Pose> pose_in(tf::Transform(tf::Quaternion(q_in.x, q_in.y, q_in.z, q_in.w),
-                                              tf::Vector3(p_in.x, p_in.y, p_in.z)),
-                                feedback.header.stamp, feedback.header.frame_id);
-  tf::Stamped<tf::Pose> pose_out;
-  try {
-    context_->getTFClient()->transformPose(parent_frame_property_->getFrameStd(),
-                                           pose_in, pose_out);
-  } catch(const std::runtime_error &e) {
-    ROS_DEBUG("Error transforming from frame '%s' to frame '%s': %s",
-              feedback.header.frame_id.c_str(),
-              parent_frame_property_->getFrameStd().c_str(),
-              e.what());
-    return;
+  Eigen::Vector3d p(p_in.x, p_in.y, p_in.z);
+  Eigen::Quaterniond q(q_in.w, q_in.x, q_in.y, q_in.z);
+
+  Eigen::Affine3d ref;
+  if (feedback.header.frame_id == parent_frame) {
+    // frame-locked marker: feedback is already w.r.t. parent frame
+  } else if (feedback.header.frame_id == fixed_frame_id_.str() &&
+             lookupFrame(parent_frame_id_, ref)) {
+    // feedback w.r.t. fixed frame: use cached parent frame transform
+    Eigen::Affine3d pose = ref.inverse() * (Eigen::Translation3d(p) * q);
+    p = pose.translation();
+    q = Eigen::Quaterniond(pose.rotation());
+  } else {
+    geometry_msgs::PoseStamped pose_in, pose_out;
+    pose_in.header = feedback.header;
+    pose_in.pose = feedback.pose;
+    try {
+      const geometry_msgs::TransformStamped tf =
+          context_->getFrameManager()->getTF2BufferPtr()->lookupTransform(
+            parent_frame, feedback.header.frame_id, feedback.header.stamp);
+      tf2::doTransform(pose_in, pose_out, tf);
+    } catch(const tf2::TransformException &e) {
+      ROS_DEBUG("Error transforming from frame '%s' to frame '%s': %s",
+                feedback.header.frame_id.c_str(), parent_frame.c_str(), e.what());
+      return;
+    }
+    const geometry_msgs::Point &tp = pose_out.pose.position;
+    const geometry_msgs::Quaternion &tq = pose_out.pose.orientation;
+    p = Eigen::Vector3d(tp.x, tp.y, tp.z);
+    q = Eigen::Quaterniond(tq.w, tq.x, tq.y, tq.z);
   }
 
-  const tf::Vector3 &p = pose_out.getOrigin();
-  const tf::Quaternion &q = pose_out.getRotation();
-
   ignore_updates_ = true;
   translation_property_->setVector(Ogre::Vector3(p.x(), p.y(), p.z()));
-  rotation_property_->setQuaternion(Eigen::Quaterniond(q.w(), q.x(), q.y(), q.z()));
+  rotation_property_->setQuaternion(q);
   ignore_updates_ = false;
 
   updatePose(feedback.pose, rotation_property_->getQuaternion(),
              translation_property_->getVector());
   tf_pub_->setPose(feedback.pose);
+  feedback_time_.add((ros::WallTime::now() - start).toSec());
 }
 
 void TransformPublisherDisplay::onBroadcastEnableChanged()
 {
-  tf_pub_->setEnabled(broadcast_property_->getBool());
+  tf_pub_->setEnabled(isEnabled() && broadcast_property_->getBool());
+}
+
+void TransformPublisherDisplay::onMaxRateChanged()
+{
+  tf_pub_->setMaxRate(max_rate_property_->getFloat());
+}
+
+void TransformPublisherDisplay::onDynamicChanged()
+{
+  tf_pub_->setDynamicRate(dynamic_rate_property_->getFloat());
+  if (!dynamic_property_->getBool())
+    tf_pub_->setDynamic(false);
+}
+
+void TransformPublisherDisplay::onToleranceChanged()
+{
+  tf_pub_->setTolerance(translation_tolerance_property_->getFloat(),
+                        angle_tolerance_property_->getFloat() * M_PI / 180.0);
 }
 
 void TransformPublisherDisplay::onMarkerTypeChanged()
 {
+  if (loading_) return; // marker is created after loading
+  cancelTransformable(); // retry immediately if creation fails
   createInteractiveMarker(marker_property_->getOptionInt());
 }
 
@@ -436,7 +664,8 @@ void TransformPublisherDisplay::onMarkerScaleChanged()
 {
   if (marker_scale_property_->getFloat() <= 0)
     marker_scale_property_->setFloat(0.2);
-  createInteractiveMarker(marker_property_->getOptionInt());
+  // defer marker update to next update() cycle, coalescing fast scale changes
+  marker_update_pending_ = true;
 }
 
 } // namespace agni_tf_tools
@@ -35,7 +35,14 @@
 #include <ros/ros.h>
 #include <visualization_msgs/InteractiveMarker.h>
 #include <visualization_msgs/InteractiveMarkerFeedback.h>
+#include <visualization_msgs/InteractiveMarkerPose.h>
 #include <geometry_msgs/PoseStamped.h>
+#include <tf2/buffer_core.h>
+#include <Eigen/Geometry>
+#include <boost/atomic.hpp>
+#include <boost/signals2/connection.hpp>
+#include "Statistics.h"
+#include "FrameId.h"
 
 // forward declarations of classes
 namespace rviz
@@ -69,17 +76,33 @@ public:
   ~TransformPublisherDisplay();
 
   void reset();
+  /// load config, applying all loaded property values at once
+  void load(const rviz::Config &config);
 
 protected:
   void onInitialize();
   void onEnable();
   void onDisable();
   void update(float wall_dt, float ros_dt);
+  void fixedFrameChanged();
 
-  void addFrameControls(visualization_msgs::InteractiveMarker &im, double scale, bool interactive);
-  void add6DOFControls(visualization_msgs::InteractiveMarker &im);
   bool createInteractiveMarker(int type);
+  /// retrieve (cached) unit-scale control template for given marker type
+  const visualization_msgs::InteractiveMarker &markerTemplate(int type);
   bool fillPoseStamped(std_msgs::Header &header, geometry_msgs::Pose &pose);
+  /// (cached) lookup of frame w.r.t. fixed frame
+  bool lookupFrame(const FrameId &frame, Eigen::Affine3d &tf, std::string *error = 0);
+  /// re-resolve interned frames from properties
+  void updateFrameIds();
+  void onTransformsChanged();
+  /// called from tf thread once parent frame becomes transformable into fixed frame
+  void onTransformable();
+  /// ask tf to signal readiness of parent frame instead of polling in update()
+  void requestTransformable();
+  /// cancel pending readiness request and retry marker creation immediately
+  void cancelTransformable();
+  /// refresh statistics status entries and diagnostics (once per second)
+  void updateStatistics(float wall_dt);
 
 protected Q_SLOTS:
   void setStatus(int level, const QString &name, const QString &text);
@@ -90,6 +113,10 @@ protected Q_SLOTS:
   void onTransformChanged();
   void onMarkerFeedback(visualization_msgs::InteractiveMarkerFeedback &feedback);
   void onBroadcastEnableChanged();
+  void onMaxRateChanged();
+  void onDynamicChanged();
+  void onToleranceChanged();
+  void onStatisticsChanged();
   void onMarkerTypeChanged();
   void onMarkerScaleChanged();
 
@@ -98,12 +125,22 @@ private:
   rviz::VectorProperty *translation_property_;
   RotationProperty *rotation_property_;
   rviz::BoolProperty *broadcast_property_;
+  rviz::FloatProperty *max_rate_property_;
+  rviz::BoolProperty *dynamic_property_;
+  rviz::FloatProperty *dynamic_rate_property_;
+  rviz::FloatProperty *translation_tolerance_property_;
+  rviz::FloatProperty *angle_tolerance_property_;
   rviz::TfFrameProperty *parent_frame_property_;
   rviz::BoolProperty *adapt_transform_property_;
-  std::string prev_parent_frame_;
+  FrameId prev_parent_frame_;
   rviz::TfFrameProperty *child_frame_property_;
+  // interned frames of properties, resolving the fixed frame
+  FrameId parent_frame_id_, child_frame_id_, fixed_frame_id_;
+  visualization_msgs::InteractiveMarkerPose marker_pose_; // reused for marker pose updates
   rviz::EnumProperty *marker_property_;
   rviz::FloatProperty *marker_scale_property_;
+  rviz::BoolProperty *statistics_property_;
+  rviz::BoolProperty *diagnostics_property_;
 
   // tf publisher
   TransformBroadcaster *tf_pub_;
@@ -111,7 +148,37 @@ private:
   // interactive marker stuff
   boost::shared_ptr<rviz::InteractiveMarker> imarker_;
   Ogre::SceneNode *marker_node_;
+  std::map<int, visualization_msgs::InteractiveMarker> marker_templates_;
+  bool marker_update_pending_; // marker needs to be rebuilt in next update()
+  bool marker_refresh_pending_; // imarker_ needs update(), e.g. for a frame-lock change
+  bool dragging_; // between MOUSE_DOWN and MOUSE_UP
+  float retry_delay_; // back-off delay between marker creation attempts
+  float retry_elapsed_; // time since last marker creation attempt
+  tf2::TransformableCallbackHandle tf_callback_; // readiness callback registered with tf buffer
+  tf2::TransformableRequestHandle tf_request_; // pending readiness request (0: none)
+  boost::atomic<bool> tf_ready_; // set from tf thread when request was answered
   bool ignore_updates_ ;
+  bool loading_; // within load(): defer reactions to property changes
+  // instrumentation
+  float status_time_; // time since last statistics status update
+  unsigned long notifications_; // rotation notifications reported last
+  unsigned long publishes_, dynamic_publishes_; // publish counters reported last
+  LatencyHistogram update_time_;
+  LatencyHistogram feedback_time_;
+  LatencyHistogram lookup_time_;
+  ros::Publisher diagnostics_pub_;
+
+  // cached transform of (parent) frame w.r.t. fixed frame
+  struct FrameCache {
+    bool valid;
+    FrameId frame;
+    bool has_problems; // result of FrameManager::transformHasProblems
+    std::string error;
+    bool available; // result of FrameManager::getTransform
+    Eigen::Affine3d tf;
+  } frame_cache_;
+  boost::atomic<bool> tf_changed_; // set from tf thread on tf changes
+  boost::signals2::connection tf_changed_connection_;
 };
 
 } // namespace rviz_cbf_plugin
@@ -29,12 +29,13 @@
  * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
  */
 
-#include <QStringList>
+#include <QString>
 #include <rviz/properties/float_property.h>
 #include <rviz/properties/status_property.h>
 #include <angles/angles.h>
-#include <boost/format.hpp>
-#include <boost/assign/list_of.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include "euler_property.h"
 
 namespace rviz
@@ -49,7 +50,8 @@ EulerProperty::EulerProperty(Property* parent, const QString& name,
                              const Eigen::Quaterniond& value,
                              const char *changed_slot,
                              QObject* receiver)
-  : Property(name, QVariant(),
+  // a valid (string) value_ makes the row editable, the text itself is formatted lazily in getValue()
+  : Property(name, QString(),
              "Angles specified in degrees.\n"
              "Choose axes with spec like xyz, zxz, or rpy.\n"
              "Composition w.r.t. the static or rotating frame\n"
@@ -59,6 +61,10 @@ EulerProperty::EulerProperty(Property* parent, const QString& name,
   , ignore_child_updates_(false)
   , angles_read_only_(false)
   , update_string_(true)
+  , string_valid_(false)
+  , update_depth_(0)
+  , pending_changed_(false)
+  , pending_quaternion_(false)
 {
   euler_[0] = new FloatProperty("", 0, "rotation angle about first axis", this);
   euler_[1] = new FloatProperty("", 0, "rotation angle about second axis", this);
@@ -79,41 +85,66 @@ void EulerProperty::setQuaternion(const Eigen::Quaterniond& q)
 
 void EulerProperty::setEulerAngles(double euler[], bool normalize)
 {
-  Eigen::Quaterniond q;
-  if (fixed_)
-    q = Eigen::AngleAxisd(euler[2], Eigen::Vector3d::Unit(axes_[2])) *
-        Eigen::AngleAxisd(euler[1], Eigen::Vector3d::Unit(axes_[1])) *
-        Eigen::AngleAxisd(euler[0], Eigen::Vector3d::Unit(axes_[0]));
-  else
-    q = Eigen::AngleAxisd(euler[0], Eigen::Vector3d::Unit(axes_[0])) *
-        Eigen::AngleAxisd(euler[1], Eigen::Vector3d::Unit(axes_[1])) *
-        Eigen::AngleAxisd(euler[2], Eigen::Vector3d::Unit(axes_[2]));
+  Eigen::Quaterniond q = convention_.quaternion(euler[0], euler[1], euler[2]);
 
   if (normalize) setQuaternion(q);
   else {
+    UpdateScope<EulerProperty> scope(this);
+
+    // updating children must not trigger updateFromChildren() with partially updated angles
+    const bool from_children = ignore_child_updates_;
+    ignore_child_updates_ = true;
     for (int i=0; i < 3; ++i) {
       float deg = angles::to_degrees(euler[i]);
       if (!Eigen::internal::isApprox(deg, euler_[i]->getFloat())) {
         update_string_ = true;
-        if (!ignore_child_updates_)
+        if (!from_children)
           euler_[i]->setValue(deg);
       }
     }
+    ignore_child_updates_ = from_children;
 
     if (!quaternion_.isApprox(q)) {
-      Q_EMIT aboutToChange();
+      markChanged(true);
       quaternion_ = q;
-      Q_EMIT quaternionChanged(q);
     } else if (update_string_) {
-      Q_EMIT aboutToChange();
-    } else { // there is nothing to update at all
-      return;
-    }
-    updateString();
+      markChanged(false);
+    } // else: there is nothing to update at all
+  }
+}
+
+void EulerProperty::beginUpdate()
+{
+  ++update_depth_;
+}
+
+void EulerProperty::endUpdate()
+{
+  if (--update_depth_ > 0) return;
+
+  if (pending_quaternion_) {
+    pending_quaternion_ = false;
+    Q_EMIT quaternionChanged(quaternion_);
+  }
+  if (pending_changed_) {
+    pending_changed_ = false;
+    // any change (incl. angles edited in the children) affects the string: reformat on next getValue()
+    update_string_ = false;
+    string_valid_ = false;
     Q_EMIT changed();
   }
 }
 
+void EulerProperty::markChanged(bool quaternion_changed)
+{
+  if (!pending_changed_) {
+    Q_EMIT aboutToChange();
+    pending_changed_ = true;
+  }
+  if (quaternion_changed)
+    pending_quaternion_ = true;
+}
+
 void EulerProperty::setEulerAngles(double e1, double e2, double e3, bool normalize)
 {
   double euler[3] = {e1,e2,e3};
@@ -122,75 +153,111 @@ void EulerProperty::setEulerAngles(double e1, double e2, double e3, bool normali
 
 void EulerProperty::setEulerAxes(const QString &axes_spec)
 {
-  static const std::vector<QString> xyzNames = boost::assign::list_of("x")("y")("z");
-  static const std::vector<QString> rpyNames = boost::assign::list_of("roll")("pitch")("yaw");
-  const std::vector<QString> *names = &xyzNames;
+  static const char* const XYZ_NAMES[] = {"x", "y", "z"};
+  static const char* const RPY_NAMES[] = {"roll", "pitch", "yaw"};
+  // parsed conventions by spec string, only valid ones are cached
+  static std::map<QString, euler::Convention> cache;
 
   if (axes_string_ == axes_spec) return;
-  QString sAxes = axes_spec;
-  if (sAxes == "rpy") {
-    sAxes = "sxyz";
-    names = &rpyNames;
-  } else if (sAxes == "ypr") {
-    sAxes = "rzyx";
-    names = &rpyNames;
-  }
-
-  // static or rotated frame order?
-  QString::iterator pc = sAxes.begin();
-  bool fixed;
-  if (*pc == 's') fixed = true;
-  else if (*pc == 'r') fixed = false;
-  else {fixed = false; --pc;}
-  ++pc; // advance to first axis char
-
-  // need to have 3 axes specs
-  if (sAxes.end() - pc != 3)
-    throw invalid_axes((boost::format("Invalid axes spec: %s. Expecting 3 chars from [xyz]")
-                        % axes_spec.toStdString()).str());
-
-  // parse axes specs into indexes
-  uint axes[3];
-  for (int i=0; i < 3; ++i, ++pc) {
-    int idx = pc->toLatin1() - 'x';
-    if (idx < 0 || idx > 2)
-      throw invalid_axes((boost::format("invalid axis char: %c (only xyz allowed)") % pc->unicode()).str());
-    if (i > 0 && axes[i-1] == idx)
-      throw invalid_axes("consecutive axes need to be different");
-    axes[i] = idx;
+  const char* const *names = (axes_spec == "rpy" || axes_spec == "ypr") ? RPY_NAMES : XYZ_NAMES;
+
+  std::map<QString, euler::Convention>::const_iterator it = cache.find(axes_spec);
+  if (it == cache.end()) {
+    euler::Convention convention;
+    std::string error;
+    if (!convention.parse(axes_spec.toStdString(), &error))
+      throw invalid_axes(error);
+    it = cache.insert(std::make_pair(axes_spec, convention)).first;
   }
 
   // everything OK: accept changes
+  UpdateScope<EulerProperty> scope(this);
   axes_string_ = axes_spec;
-  fixed_ = fixed;
-  for (int i=0; i < 3; ++i) {
-    axes_[i] = axes[i];
-    euler_[i]->setName((*names)[axes[i]]);
-  }
+  convention_ = it->second;
+  for (int i=0; i < 3; ++i)
+    euler_[i]->setName(names[convention_.axes()[i]]);
 
   // finally compute euler angles matching the new axes
   update_string_ = true;
   updateAngles(quaternion_);
 }
 
+static inline bool isSpace(const QChar *p) { return p->unicode() == ' ' || p->unicode() == '\t'; }
+static inline bool isDigit(const QChar *p) { return p->unicode() >= '0' && p->unicode() <= '9'; }
+
+static const QChar* skipSpace(const QChar *p, const QChar *end)
+{
+  while (p != end && isSpace(p)) ++p;
+  return p;
+}
+
+/// parse a decimal number (independent of locale), return end of parsed number or 0 on failure
+static const QChar* parseNumber(const QChar *p, const QChar *end, double &value)
+{
+  bool negative = false;
+  if (p != end && (p->unicode() == '-' || p->unicode() == '+'))
+    negative = (p++)->unicode() == '-';
+
+  unsigned long long mantissa = 0;
+  int exponent = 0, digits = 0;
+  for (; p != end && isDigit(p); ++p, ++digits) {
+    if (mantissa < 100000000000000000ULL) mantissa = 10 * mantissa + (p->unicode() - '0');
+    else ++exponent; // ignore insignificant digits
+  }
+  if (p != end && p->unicode() == '.') {
+    for (++p; p != end && isDigit(p); ++p, ++digits) {
+      if (mantissa < 100000000000000000ULL) {
+        mantissa = 10 * mantissa + (p->unicode() - '0');
+        --exponent;
+      }
+    }
+  }
+  if (digits == 0) return 0;
+
+  if (p != end && (p->unicode() == 'e' || p->unicode() == 'E')) {
+    const QChar *q = p + 1;
+    bool exp_negative = false;
+    if (q != end && (q->unicode() == '-' || q->unicode() == '+'))
+      exp_negative = (q++)->unicode() == '-';
+    if (q == end || !isDigit(q)) return 0;
+    int e = 0;
+    for (; q != end && isDigit(q); ++q)
+      if (e < 1000) e = 10 * e + (q->unicode() - '0');
+    exponent += exp_negative ? -e : e;
+    p = q;
+  }
+  value = mantissa * std::pow(10.0, exponent);
+  if (negative) value = -value;
+  return p;
+}
+
 bool EulerProperty::setValue(const QVariant& value)
 {
   static const QString statusAxes ("Euler axes");
   static const QString statusAngles ("Euler angles");
 
-  const QRegExp axesSpec("\\s*([a-z]+)\\s*:?");
-  QString s = value.toString();
+  // single pass over "[axes[:]] e1[; e2; e3]"
+  const QString s = value.toString();
+  const QChar *p = skipSpace(s.constData(), s.constData() + s.size());
+  const QChar *end = s.constData() + s.size();
+  UpdateScope<EulerProperty> scope(this); // notify axes + angles changes at once
 
   // parse axes spec
-  if (axesSpec.indexIn(s) != -1) {
+  const QChar *axes = p;
+  while (p != end && p->unicode() >= 'a' && p->unicode() <= 'z') ++p;
+  if (p != axes) {
+    const int start = axes - s.constData();
     try {
-      setEulerAxes(axesSpec.cap(1));
+      // only create a new string on actual changes
+      if (QStringRef(&s, start, p - axes) != axes_string_)
+        setEulerAxes(s.mid(start, p - axes));
       Q_EMIT statusUpdate(StatusProperty::Ok, statusAxes, axes_string_);
     } catch (const invalid_axes &e) {
       Q_EMIT statusUpdate(StatusProperty::Warn, statusAxes, e.what());
       return false;
     }
-    s = s.mid(axesSpec.matchedLength());
+    p = skipSpace(p, end);
+    if (p != end && p->unicode() == ':') ++p;
   }
 
   // in read-only mode only allow to change axes, but not angles
@@ -199,34 +266,38 @@ bool EulerProperty::setValue(const QVariant& value)
     return true;
   }
 
-  if (s.trimmed().isEmpty())
+  p = skipSpace(p, end);
+  if (p == end)
     return true; // allow change of axes only
 
-  // parse angles
-  QStringList strings = s.split(';');
+  // parse semicolon-separated angles
   double euler[3];
-  bool ok = true;
-  for (int i=0; i < 3 && ok; ++i)
-  {
-    if (i < strings.size())
-      euler[i] = angles::from_degrees(strings[i].toDouble(&ok));
-    else // providing a single value will set all angles to this (1st) value
-      euler[i] = euler[0];
-  }
-  if (!ok)
-  {
-    Q_EMIT statusUpdate(StatusProperty::Warn, statusAngles,
-                        "failed to parse angle value");
-    return false;
+  int count = 0;
+  while (true) {
+    double angle;
+    p = parseNumber(skipSpace(p, end), end, angle);
+    if (p) p = skipSpace(p, end);
+    if (!p || (p != end && p->unicode() != ';')) {
+      Q_EMIT statusUpdate(StatusProperty::Warn, statusAngles,
+                          "failed to parse angle value");
+      return false;
+    }
+    if (count < 3) euler[count] = angles::from_degrees(angle);
+    ++count;
+    if (p == end) break;
+    ++p; // skip ';'
   }
-  if (strings.size() != 3 && strings.size() != 1) {
+  if (count != 3 && count != 1) {
     Q_EMIT statusUpdate(StatusProperty::Warn, statusAngles,
                         "expecting 3 semicolon-separated values");
     return false;
   }
+  if (count == 1) // providing a single value will set all angles to this value
+    euler[1] = euler[2] = euler[0];
 
   Q_EMIT statusUpdate(StatusProperty::Ok, statusAngles, "");
   setEulerAngles(euler, false);
+  return true;
 }
 
 void EulerProperty::updateFromChildren()
@@ -249,24 +320,58 @@ void EulerProperty::emitAboutToChange()
 
 void EulerProperty::updateAngles(const Eigen::Quaterniond &q)
 {
-  Eigen::Vector3d e;
-  if (fixed_) {
-    e = q.matrix().eulerAngles(axes_[2], axes_[1], axes_[0]);
-    std::swap(e[0], e[2]);
-  } else
-    e = q.matrix().eulerAngles(axes_[0], axes_[1], axes_[2]);
+  Eigen::Vector3d e = convention_.eulerAngles(q);
   setEulerAngles(e.data(), false);
 }
 
-void EulerProperty::updateString()
+/// format angle with one decimal, omitting a zero decimal, return end of output
+static char* formatAngle(char *out, float deg)
+{
+  if (!(std::fabs(deg) < 1e15f)) { // out of range for integer formatting (or nan)
+    const QByteArray s = QByteArray::number(deg, 'g', 6);
+    return std::copy(s.constData(), s.constData() + s.size(), out);
+  }
+  long long v = std::llround(deg * 10.0);
+  if (v < 0) {
+    *out++ = '-';
+    v = -v;
+  }
+  char digits[24];
+  int n = 0;
+  long long integral = v / 10;
+  do {
+    digits[n++] = '0' + integral % 10;
+    integral /= 10;
+  } while (integral);
+  while (n) *out++ = digits[--n];
+  if (v % 10) {
+    *out++ = '.';
+    *out++ = '0' + v % 10;
+  }
+  return out;
+}
+
+QVariant EulerProperty::getValue() const
+{
+  if (!string_valid_) formatString();
+  return string_;
+}
+
+void EulerProperty::formatString() const
 {
-  QString s = QString("%1: %2; %3; %4")
-      .arg(axes_string_)
-      .arg(euler_[0]->getFloat(), 0, 'f', 1)
-      .arg(euler_[1]->getFloat(), 0, 'f', 1)
-      .arg(euler_[2]->getFloat(), 0, 'f', 1);
-  value_ = s.replace(".0", "");
-  update_string_ = false; // reset update flag
+  char buffer[128];
+  char *p = buffer;
+  const int axes = std::min(axes_string_.size(), 16);
+  for (int i = 0; i < axes; ++i)
+    *p++ = axes_string_[i].toLatin1();
+  *p++ = ':';
+  for (int i = 0; i < 3; ++i) {
+    *p++ = ' ';
+    p = formatAngle(p, euler_[i]->getFloat());
+    if (i < 2) *p++ = ';';
+  }
+  string_ = QString::fromLatin1(buffer, p - buffer);
+  string_valid_ = true;
 }
 
 void EulerProperty::load(const Config& config)
@@ -280,6 +385,7 @@ void EulerProperty::load(const Config& config)
   {
     // Setting the value once is better than letting the Property class
     // load all parameters independently, which would result in 4 update calls
+    UpdateScope<EulerProperty> scope(this);
     setEulerAxes(axes);
     for (int i=0; i < 3; ++i)
       euler[i] = angles::from_degrees(euler[i]);
@@ -35,6 +35,8 @@
 #include <Eigen/Geometry>
 #include <stdexcept>
 
+#include "EulerConversion.h"
+
 #include "rviz/properties/property.h"
 
 namespace rviz
@@ -42,6 +44,17 @@ namespace rviz
 
 class FloatProperty;
 
+/// RAII helper batching modifications of a property between beginUpdate() and endUpdate()
+template <class P>
+class UpdateScope
+{
+public:
+  explicit UpdateScope(P *property) : property_(property) { property_->beginUpdate(); }
+  ~UpdateScope() { property_->endUpdate(); }
+private:
+  P *property_;
+};
+
 class EulerProperty: public Property
 {
   Q_OBJECT
@@ -59,6 +72,8 @@ public:
 
   Eigen::Quaterniond getQuaternion() const {return quaternion_;}
   virtual bool setValue(const QVariant& value);
+  /** @brief Return summary string "axes: e1; e2; e3", which is only formatted on demand */
+  virtual QVariant getValue() const;
 
   /** @brief Load the value of this property and/or its children from
    * the given Config node. */
@@ -69,6 +84,11 @@ public:
   virtual void setReadOnly(bool read_only);
   bool getAnglesReadOnly() {return angles_read_only_;}
 
+  /** @brief Batch several modifications: changed() and quaternionChanged()
+   *  are emitted only once, when the outermost endUpdate() is reached. */
+  void beginUpdate();
+  void endUpdate();
+
 public Q_SLOTS:
   void setQuaternion(const Eigen::Quaterniond &q);
   void setEulerAngles(double euler[3], bool normalize);
@@ -91,16 +111,22 @@ Q_SIGNALS:
 
 private:
   void updateAngles(const Eigen::Quaterniond &q);
-  void updateString();
+  void formatString() const;
+  /// record a change to be notified by endUpdate()
+  void markChanged(bool quaternion_changed);
 
   Eigen::Quaterniond quaternion_;
   QString   axes_string_;
-  uint      axes_[3]; // unit axis index for i-th rotation
-  bool      fixed_;
+  euler::Convention convention_;
   FloatProperty* euler_[3];
   bool ignore_child_updates_;
   bool angles_read_only_;
-  bool update_string_; // do we have any changes triggering an updateString()?
+  bool update_string_; // do we have any changes affecting the summary string?
+  mutable QString string_; // summary string, formatted lazily by getValue()
+  mutable bool string_valid_;
+  int update_depth_; // nesting level of beginUpdate()
+  bool pending_changed_; // changed() pending for endUpdate()
+  bool pending_quaternion_; // quaternionChanged() pending for endUpdate()
 };
 
 } // end namespace rviz
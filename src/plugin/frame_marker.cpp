@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2016, Bielefeld University, CITEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Robert Haschke <rhaschke@techfak.uni-bielefeld.de>
+ */
+
+#include "frame_marker.h"
+#include <interactive_markers/tools.h>
+#include <Eigen/Geometry>
+#include <QColor>
+
+namespace vm = visualization_msgs;
+
+namespace agni_tf_tools
+{
+
+static vm::Marker createArrowMarker(double scale,
+                                    const Eigen::Vector3d &dir,
+                                    const QColor &color) {
+  vm::Marker marker;
+
+  marker.type = vm::Marker::ARROW;
+  marker.scale.x = scale;
+  marker.scale.y = 0.1*scale;
+  marker.scale.z = 0.1*scale;
+
+  const Eigen::Quaterniond q = Eigen::Quaterniond::FromTwoVectors(Eigen::Vector3d::UnitX(), dir);
+  marker.pose.orientation.w = q.w();
+  marker.pose.orientation.x = q.x();
+  marker.pose.orientation.y = q.y();
+  marker.pose.orientation.z = q.z();
+
+  marker.color.r = color.redF();
+  marker.color.g = color.greenF();
+  marker.color.b = color.blueF();
+  marker.color.a = color.alphaF();
+
+  return marker;
+}
+
+inline void setOrientation(geometry_msgs::Quaternion &q, double w, double x, double y, double z) {
+  q.w = w;
+  q.x = x;
+  q.y = y;
+  q.z = z;
+}
+
+void addFrameControls(vm::InteractiveMarker &im, double scale, bool interactive)
+{
+  vm::InteractiveMarkerControl ctrl;
+  setOrientation(ctrl.orientation, 1, 0,0,0);
+  ctrl.always_visible = true;
+  if (interactive) {
+    ctrl.orientation_mode = vm::InteractiveMarkerControl::VIEW_FACING;
+    ctrl.independent_marker_orientation = true;
+    ctrl.interaction_mode = vm::InteractiveMarkerControl::MOVE_ROTATE_3D;
+  }
+  ctrl.name = "frame";
+
+  ctrl.markers.push_back(createArrowMarker(im.scale * scale, Eigen::Vector3d::UnitX(), QColor("red")));
+  ctrl.markers.push_back(createArrowMarker(im.scale * scale, Eigen::Vector3d::UnitY(), QColor("green")));
+  ctrl.markers.push_back(createArrowMarker(im.scale * scale, Eigen::Vector3d::UnitZ(), QColor("blue")));
+
+  im.controls.push_back(ctrl);
+}
+
+void add6DOFControls(vm::InteractiveMarker &im) {
+  vm::InteractiveMarkerControl ctrl;
+  ctrl.always_visible = false;
+
+  setOrientation(ctrl.orientation, 1, 1,0,0);
+  ctrl.interaction_mode = vm::InteractiveMarkerControl::MOVE_AXIS;
+  ctrl.name = "x pos";
+  im.controls.push_back(ctrl);
+  ctrl.interaction_mode = vm::InteractiveMarkerControl::ROTATE_AXIS;
+  ctrl.name = "x rot";
+  im.controls.push_back(ctrl);
+
+  setOrientation(ctrl.orientation, 1, 0,1,0);
+  ctrl.interaction_mode = vm::InteractiveMarkerControl::MOVE_AXIS;
+  ctrl.name = "y pos";
+  im.controls.push_back(ctrl);
+  ctrl.interaction_mode = vm::InteractiveMarkerControl::ROTATE_AXIS;
+  ctrl.name = "y rot";
+  im.controls.push_back(ctrl);
+
+  setOrientation(ctrl.orientation, 1, 0,0,1);
+  ctrl.interaction_mode = vm::InteractiveMarkerControl::MOVE_AXIS;
+  ctrl.name = "z pos";
+  im.controls.push_back(ctrl);
+  ctrl.interaction_mode = vm::InteractiveMarkerControl::ROTATE_AXIS;
+  ctrl.name = "z rot";
+  im.controls.push_back(ctrl);
+}
+
+void scaleMarker(vm::InteractiveMarker &im, double scale)
+{
+  im.scale *= scale;
+  for (std::vector<vm::InteractiveMarkerControl>::iterator c = im.controls.begin(), c_end = im.controls.end();
+       c != c_end; ++c) {
+    for (std::vector<vm::Marker>::iterator m = c->markers.begin(), m_end = c->markers.end();
+         m != m_end; ++m) {
+      m->pose.position.x *= scale;
+      m->pose.position.y *= scale;
+      m->pose.position.z *= scale;
+      m->scale.x *= scale;
+      m->scale.y *= scale;
+      m->scale.z *= scale;
+      // for triangle lists, points are already scaled by marker.scale
+      if (m->type == vm::Marker::TRIANGLE_LIST) continue;
+      for (std::vector<geometry_msgs::Point>::iterator p = m->points.begin(), p_end = m->points.end();
+           p != p_end; ++p) {
+        p->x *= scale;
+        p->y *= scale;
+        p->z *= scale;
+      }
+    }
+  }
+}
+
+vm::InteractiveMarker createMarkerTemplate(int type, const std::string &name)
+{
+  vm::InteractiveMarker im;
+  im.name = name;
+  im.scale = 1.0;
+
+  if (type == FRAME || type == IFRAME)
+    addFrameControls(im, 1.0, type == IFRAME);
+  else if (type == DOF6) {
+    addFrameControls(im, 0.5, type == IFRAME);
+    add6DOFControls(im);
+  }
+
+  // fill in default controls
+  interactive_markers::autoComplete(im, true);
+  return im;
+}
+
+} // namespace agni_tf_tools
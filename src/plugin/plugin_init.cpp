@@ -1,4 +1,6 @@
 #include <pluginlib/class_list_macros.h>
 #include "TransformPublisherDisplay.h"
+#include "TransformGroupDisplay.h"
 
 PLUGINLIB_EXPORT_CLASS(agni_tf_tools::TransformPublisherDisplay, rviz::Display)
+PLUGINLIB_EXPORT_CLASS(agni_tf_tools::TransformGroupDisplay, rviz::Display)
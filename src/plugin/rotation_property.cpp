@@ -45,6 +45,9 @@ RotationProperty::RotationProperty(Property* parent, const QString& name,
                     parent, changed_slot, receiver)
    , ignore_quaternion_property_updates_(false)
    , show_euler_string_(true)
+   , notifications_(0)
+   , generation_(1)
+   , string_generation_(0)
 {
   euler_property_ = new EulerProperty(this, "Euler angles", value);
   quaternion_property_ = new rviz::QuaternionProperty("quaternion",
@@ -57,8 +60,7 @@ RotationProperty::RotationProperty(Property* parent, const QString& name,
           this, SIGNAL(statusUpdate(int,QString,QString)));
   // forward quaternion updates
   connect(euler_property_, SIGNAL(quaternionChanged(Eigen::Quaterniond)),
-          this, SIGNAL(quaternionChanged(Eigen::Quaterniond)));
-  updateString();
+          this, SLOT(forwardQuaternion(Eigen::Quaterniond)));
 }
 
 Eigen::Quaterniond RotationProperty::getQuaternion() const
@@ -83,7 +85,7 @@ void RotationProperty::updateFromEuler()
     quaternion_property_->setQuaternion(Ogre::Quaternion(q.w(), q.x(), q.y(), q.z()));
   }
   show_euler_string_ = true;
-  updateString();
+  invalidateString();
 }
 
 void RotationProperty::updateFromQuaternion()
@@ -102,7 +104,23 @@ void RotationProperty::updateFromQuaternion()
   ignore_quaternion_property_updates_ = false;
 
   show_euler_string_ = false;
-  updateString();
+  invalidateString();
+}
+
+void RotationProperty::forwardQuaternion(const Eigen::Quaterniond &q)
+{
+  ++notifications_;
+  Q_EMIT quaternionChanged(q);
+}
+
+void RotationProperty::beginUpdate()
+{
+  euler_property_->beginUpdate();
+}
+
+void RotationProperty::endUpdate()
+{
+  euler_property_->endUpdate();
 }
 
 void RotationProperty::setEulerAngles(double euler[], bool normalize)
@@ -133,16 +151,24 @@ bool RotationProperty::setValue(const QVariant& value)
   return euler_property_->setValue(value);
 }
 
-void RotationProperty::updateString()
+QVariant RotationProperty::getValue() const
 {
-  QString euler = euler_property_->getValue().toString();
-  QString quat  = QString("quat: ") + quaternion_property_->getValue().toString();
-  QString s = show_euler_string_ ? euler : quat;
-  if (getString() != s) {
-    Q_EMIT aboutToChange();
-    value_ = s;
-    Q_EMIT changed();
+  if (string_generation_ != generation_) {
+    if (show_euler_string_)
+      string_ = euler_property_->getValue().toString();
+    else
+      string_ = QString("quat: ") + quaternion_property_->getValue().toString();
+    string_generation_ = generation_;
   }
+  return string_;
+}
+
+void RotationProperty::invalidateString()
+{
+  Q_EMIT aboutToChange();
+  ++generation_;
+  ++notifications_;
+  Q_EMIT changed();
 }
 
 void RotationProperty::load(const Config& config)
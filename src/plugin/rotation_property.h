@@ -54,6 +54,8 @@ public:
 
   Eigen::Quaterniond getQuaternion() const;
   virtual bool setValue(const QVariant& value);
+  /** @brief Return Euler or quaternion string, which is only formatted on demand */
+  virtual QVariant getValue() const;
 
   /** @brief Load the value of this property and/or its children from the given Config node. */
   virtual void load(const rviz::Config& config);
@@ -62,6 +64,13 @@ public:
   /** @brief Overridden from Property to propagate read-only-ness to children. */
   virtual void setReadOnly(bool read_only);
 
+  /** @brief Batch several modifications into a single notification, see EulerProperty */
+  void beginUpdate();
+  void endUpdate();
+
+  /// number of changed() + quaternionChanged() notifications emitted so far
+  unsigned long notifications() const {return notifications_;}
+
 public Q_SLOTS:
   void setQuaternion(const Eigen::Quaterniond &q);
   void setEulerAngles(double euler[3], bool normalize);
@@ -71,6 +80,7 @@ public Q_SLOTS:
 private Q_SLOTS:
   void updateFromEuler();
   void updateFromQuaternion();
+  void forwardQuaternion(const Eigen::Quaterniond &q);
 
 Q_SIGNALS:
   /** signal emitted when quaternion value has changed */
@@ -79,12 +89,17 @@ Q_SIGNALS:
   void statusUpdate(int, const QString&, const QString&);
 
 private:
-  void updateString();
+  /// notify about a changed string, which is formatted lazily by getValue()
+  void invalidateString();
 
   rviz::EulerProperty *euler_property_;
   rviz::QuaternionProperty *quaternion_property_;
   bool ignore_quaternion_property_updates_;
   bool show_euler_string_;
+  unsigned long notifications_;
+  unsigned long generation_; // incremented on each change of the rotation or its representation
+  mutable unsigned long string_generation_; // generation of string_
+  mutable QString string_;
 };
 
 } // end namespace agni_tf_tools
@@ -27,157 +27,380 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <tf2_ros/static_transform_broadcaster.h>
-#include <Eigen/Geometry>
+#include <ros/ros.h>
+#include <tf2_msgs/TFMessage.h>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <boost/scoped_ptr.hpp>
 
-#include <boost/program_options.hpp>
-namespace po=boost::program_options;
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-static void usage (const char* prog_name, const po::options_description &opts, bool desc=false) {
+#include "transform_parser.h"
+#include "common/BulkConversion.h"
+#include "common/ChunkedTransformPublisher.h"
+
+typedef std::vector<geometry_msgs::TransformStamped> Transforms;
+
+/// upper bound of --chunks, before its value can be compared to the number of transforms
+static const long MAX_CHUNKS = 65536;
+
+/// command-line configuration, required to reload the transform file
+struct Options {
+  Options() : mode(parse_mode("")), chunks(0) {}
+  RotationMode mode;
+  std::string filename;
+  unsigned int chunks; // publish in chunks instead of a single latched message
+  std::vector<Tuple> tuples; // tuples given on the command line (referring to argv)
+};
+
+static void usage (const char* prog_name, bool desc=false) {
   if (desc) {
-    std::cout << "A command line utility for manually defining a (static) transform" << std::endl;
+    std::cout << "A command line utility for manually defining (static) transforms" << std::endl;
     std::cout << "from parent_frame_id to child_frame_id." << std::endl;
+    std::cout << "Several transforms can be given, separated by a single comma argument," << std::endl;
+    std::cout << "or read from a file, listing one transform per line ('#' starts a comment)." << std::endl;
+    std::cout << "The file is watched for modifications and reloaded automatically." << std::endl;
   }
   std::cout << std::endl;
-  std::cout << "Usage: static_transform_publisher [options] x y z  <rotation> parent_frame_id child_frame_id" << std::endl;
-  std::cout << opts << std::endl;
+  std::cout << "Usage: static_transform_publisher [options] x y z  <rotation> parent_frame_id child_frame_id [, ...]" << std::endl;
+  std::cout << "allowed options:" << std::endl;
+  std::cout << "  -h [ --help ]         show this help message" << std::endl;
+  std::cout << "  -m [ --mode ] arg     rotation mode: xyzw, wxyz, or Euler axes (e.g. zyx, sxyz, rpy)" << std::endl;
+  std::cout << "  -f [ --file ] arg     read transforms from file (reloaded on changes)" << std::endl;
+  std::cout << "  -c [ --chunks ] arg   publish in arg content-hashed chunks, only re-sending changed ones" << std::endl;
+  std::cout << std::endl;
 }
 
-static void parse_arguments(int argc, char **argv,
-                            geometry_msgs::TransformStamped &msg) {
-  std::string mode;
-  po::options_description options_description("allowed options");
-  options_description.add_options()
-      ("help,h", "show this help message")
-      ("mode,m", po::value<std::string>(&mode))
-      ;
-
-  po::variables_map variables_map;
-  std::vector<std::string> args;
-  std::vector<std::string>::const_iterator arg;
-  try {
-    po::parsed_options parsed =
-        po::command_line_parser(argc, argv)
-        .options(options_description)
-        .allow_unregistered()
-        .run();
-
-    po::store(parsed, variables_map);
-    po::notify(variables_map);
-    args = po::collect_unrecognized(parsed.options, po::include_positional);
-    arg = args.begin();
-
-    if (variables_map.count("help")) {
-      usage(argv[0], options_description, true);
-      exit (EXIT_SUCCESS);
-    }
-    const size_t numArgs = 3 + 2;
-
-    bool bQuatMode = (mode == "wxyz" || mode == "xyzw");
-    if (mode == "")
-    {
-      if (args.size() == numArgs+4) {
-        bQuatMode = true; // 4 rotational args trigger quaternion mode too
-        mode = "xyzw";
-      } else if (args.size() == numArgs+3) {
-        mode = "zyx";
-      } else {
-        throw po::error("invalid number of positional arguments");
+/// read-only memory mapping of a whole file
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &filename) : data_(NULL), size_(0) {
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      throw ParseError("failed to open file: " + filename);
+    struct stat st;
+    void *p = MAP_FAILED;
+    if (fstat(fd, &st) == 0) // empty files cannot be mapped
+      p = st.st_size > 0 ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    const int error = errno;
+    close(fd);
+    if (p == MAP_FAILED)
+      throw ParseError("failed to read file " + filename + ": " + strerror(error));
+    data_ = static_cast<const char*>(p);
+    size_ = data_ ? st.st_size : 0;
+  }
+  ~MappedFile() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+  }
+  const char *begin() const { return data_; }
+  const char *end() const { return data_ + size_; }
+
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+
+  const char *data_;
+  size_t size_;
+};
+
+/** read tuples from file, one per line, ignoring comments and empty lines
+ *  Tokens refer to the mapped file, i.e. they are only valid as long as the file is mapped.
+ */
+static void read_tuples(const MappedFile &file, std::vector<Tuple> &tuples,
+                        std::vector<unsigned int> &lines) {
+  unsigned int lineno = 1;
+  Tuple tuple;
+  for (const char *p = file.begin(), *end = file.end(); p != end; ) {
+    if (*p == '#') { // skip comment until end of line
+      while (p != end && *p != '\n') ++p;
+    } else if (std::isspace(static_cast<unsigned char>(*p))) {
+      if (*p++ != '\n') continue;
+      if (!tuple.empty()) { // finish line
+        tuples.push_back(Tuple());
+        tuples.back().swap(tuple);
+        lines.push_back(lineno);
       }
+      ++lineno;
+    } else { // consume token
+      const char *token = p;
+      while (p != end && *p != '#' && !std::isspace(static_cast<unsigned char>(*p))) ++p;
+      tuple.push_back(Token(token, p));
     }
+  }
+  if (!tuple.empty()) { // last line without trailing newline
+    tuples.push_back(tuple);
+    lines.push_back(lineno);
+  }
+}
+
+/// parse all transforms from command-line tuples and file
+static void load_transforms(const Options &options, Transforms &transforms) {
+  std::vector<Tuple> file_tuples;
+  std::vector<unsigned int> lines;
+  boost::scoped_ptr<MappedFile> file;
+  if (!options.filename.empty()) {
+    file.reset(new MappedFile(options.filename));
+    read_tuples(*file, file_tuples, lines);
+  }
 
-    // consume position arguments
-    msg.transform.translation.x = boost::lexical_cast<double>(*arg); ++arg;
-    msg.transform.translation.y = boost::lexical_cast<double>(*arg); ++arg;
-    msg.transform.translation.z = boost::lexical_cast<double>(*arg); ++arg;
-
-    // consume orientation arguments
-    Eigen::Quaterniond q;
-    if (bQuatMode) { // parse Quaternion
-      if (args.size() != numArgs+4)
-        throw po::error("quaternion mode requires " +
-                        boost::lexical_cast<std::string>(numArgs+4) +
-                        " positional arguments");
-
-      const std::string eigen_order("xyzw");
-      double data[4];
-      for (size_t i=0; i<4; ++i) {
-        size_t idx = eigen_order.find(mode[i]);
-        data[idx] = boost::lexical_cast<double>(*arg); ++arg;
+  const size_t num_args = options.tuples.size();
+  const size_t num = num_args + file_tuples.size();
+  transforms.reserve(num);
+  std::set<std::string> children;
+  // Euler angles are collected and converted at once
+  std::vector<double> euler[3];
+  std::vector<size_t> euler_rows;
+  const euler::Convention *convention = NULL;
+  for (size_t i=0; i < num; ++i) {
+    geometry_msgs::TransformStamped msg;
+    try {
+      double e[3];
+      const RotationMode &mode =
+          parse_transform(i < num_args ? options.tuples[i] : file_tuples[i - num_args],
+                          options.mode, msg, e);
+      if (mode.type == RotationMode::EULER) {
+        // all Euler tuples share the requested or the default convention
+        convention = &mode.convention;
+        for (int k = 0; k < 3; ++k) euler[k].push_back(e[k]);
+        euler_rows.push_back(i);
       }
-      q = Eigen::Quaterniond(data);
-
-    } else { // parse Euler angles
-      if (args.size() != numArgs+3)
-        throw po::error("Euler angles require " +
-                        boost::lexical_cast<std::string>(numArgs+3) +
-                        " positional arguments");
-      if (mode.size() != 3)
-        throw po::error("mode specification for Euler angles requires a string from 3 chars (xyz)");
-
-      const std::string axes_order("xyz");
-      size_t axes_idxs[3];
-      double angles[3];
-
-      for (size_t i=0; i<3; ++i) {
-        size_t idx = axes_order.find(mode[i]);
-        if (idx == std::string::npos)
-          throw po::error("invalid axis specification for Euler angles: " +
-                          boost::lexical_cast<std::string>(mode[i]));
-        axes_idxs[i] = idx;
-        angles[i] = boost::lexical_cast<double>(*arg); ++arg;
+      if (!children.insert(msg.child_frame_id).second)
+        throw ParseError("duplicate child frame: " + msg.child_frame_id);
+    } catch (const ParseError &e) {
+      if (num == 1) throw;
+      // prefix origin of the tuple
+      throw ParseError((i < num_args ? "transform #" + std::to_string(i+1)
+                                     : options.filename + ":" + std::to_string(lines[i - num_args]))
+                       + ": " + e.what());
+    }
+    transforms.push_back(msg);
+  }
+  if (euler_rows.empty()) return;
+
+  std::vector<double> q[4];
+  for (int k = 0; k < 4; ++k) q[k].resize(euler_rows.size());
+  const double *const e_ptr[3] = { &euler[0][0], &euler[1][0], &euler[2][0] };
+  double *const q_ptr[4] = { &q[0][0], &q[1][0], &q[2][0], &q[3][0] };
+  euler::quaternions(*convention, e_ptr, q_ptr, euler_rows.size());
+  for (size_t j = 0; j < euler_rows.size(); ++j) {
+    geometry_msgs::Quaternion &rotation = transforms[euler_rows[j]].transform.rotation;
+    rotation.x = q[0][j];
+    rotation.y = q[1][j];
+    rotation.z = q[2][j];
+    rotation.w = q[3][j];
+  }
+}
+
+/// match option -o / --option, returning its value (from next argument, if not appended)
+static bool match_option(int argc, char **argv, int &i, const char *short_name,
+                         const char *long_name, const char *&value) {
+  const char *arg = argv[i];
+  const size_t long_len = std::strlen(long_name);
+  if (std::strncmp(arg, long_name, long_len) == 0 && (arg[long_len] == '\0' || arg[long_len] == '='))
+    value = arg[long_len] == '=' ? arg + long_len + 1 : NULL;
+  else if (std::strncmp(arg, short_name, 2) == 0)
+    value = arg[2] != '\0' ? arg + 2 : NULL;
+  else
+    return false;
+
+  if (!value) { // value given as next argument
+    if (++i >= argc)
+      throw ParseError(std::string("missing value for option ") + long_name);
+    value = argv[i];
+  }
+  return true;
+}
+
+static void parse_arguments(int argc, char **argv, Options &options, Transforms &transforms) {
+  try {
+    Tuple args;
+    for (int i = 1; i < argc; ++i) {
+      const char *arg = argv[i];
+      const char *value;
+      // positional arguments, including negative numbers
+      if (arg[0] != '-' || arg[1] == '\0' || arg[1] == '.' || std::isdigit(static_cast<unsigned char>(arg[1])))
+        args.push_back(Token(arg));
+      else if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0) {
+        usage(argv[0], true);
+        exit (EXIT_SUCCESS);
+      } else if (match_option(argc, argv, i, "-m", "--mode", value))
+        options.mode = parse_mode(value);
+      else if (match_option(argc, argv, i, "-f", "--file", value))
+        options.filename = value;
+      else if (match_option(argc, argv, i, "-c", "--chunks", value)) {
+        char *end;
+        errno = 0;
+        const long chunks = std::strtol(value, &end, 10);
+        if (end == value || *end != '\0' || errno == ERANGE || chunks < 0 || chunks > MAX_CHUNKS)
+          throw ParseError(std::string("invalid number of chunks: ") + value);
+        options.chunks = chunks;
       }
-      q = Eigen::AngleAxisd(angles[0], Eigen::Vector3d::Unit(axes_idxs[0])) *
-          Eigen::AngleAxisd(angles[1], Eigen::Vector3d::Unit(axes_idxs[1])) *
-          Eigen::AngleAxisd(angles[2], Eigen::Vector3d::Unit(axes_idxs[2]));
+      else
+        throw ParseError(std::string("unknown option: ") + arg);
     }
-    // assign quaternion
-    q.normalize();
-    msg.transform.rotation.x = q.x();
-    msg.transform.rotation.y = q.y();
-    msg.transform.rotation.z = q.z();
-    msg.transform.rotation.w = q.w();
-
-    // consume link arguments
-    msg.header.frame_id = *arg++;
-    msg.child_frame_id = *arg++;
-  } catch (const po::error  &e) {
+
+    if (!args.empty() || options.filename.empty())
+      split_tuples(args, options.tuples);
+    load_transforms(options, transforms);
+    // more chunks than transforms would only leave chunks empty
+    if (options.chunks > std::max<size_t>(transforms.size(), 1))
+      throw ParseError("number of chunks (" + std::to_string(options.chunks) +
+                       ") exceeds number of transforms (" + std::to_string(transforms.size()) + ")");
+  } catch (const ParseError &e) {
     ROS_FATAL_STREAM(e.what());
-    usage(argv[0], options_description);
-    exit (EXIT_FAILURE);
-  } catch (const boost::bad_lexical_cast &e) {
-    ROS_FATAL_STREAM("failed to parse numerical value: " << *arg);
-    usage(argv[0], options_description);
+    usage(argv[0]);
     exit (EXIT_FAILURE);
   }
 }
 
+static bool same_transform(const geometry_msgs::TransformStamped &a,
+                           const geometry_msgs::TransformStamped &b) {
+  const geometry_msgs::Vector3 &ta = a.transform.translation, &tb = b.transform.translation;
+  const geometry_msgs::Quaternion &ra = a.transform.rotation, &rb = b.transform.rotation;
+  return a.header.frame_id == b.header.frame_id &&
+      ta.x == tb.x && ta.y == tb.y && ta.z == tb.z &&
+      ra.x == rb.x && ra.y == rb.y && ra.z == rb.z && ra.w == rb.w;
+}
+
+/// publishes the whole set, either as a single latched message or in chunks
+class StaticPublisher {
+public:
+  explicit StaticPublisher(unsigned int chunks) {
+    if (chunks > 0)
+      chunked_.reset(new ChunkedTransformPublisher("/tf_static", chunks));
+    else
+      pub_ = ros::NodeHandle().advertise<tf2_msgs::TFMessage>("/tf_static", 100, true);
+  }
+  void publish(const Transforms &transforms) {
+    if (chunked_) {
+      chunked_->publish(transforms);
+      return;
+    }
+    tf2_msgs::TFMessage msg;
+    msg.transforms = transforms;
+    pub_.publish(msg);
+  }
+
+private:
+  ros::Publisher pub_;
+  boost::scoped_ptr<ChunkedTransformPublisher> chunked_;
+};
+
+/// reload transforms from file, publishing the new set if anything changed
+static void reload(const Options &options, Transforms &transforms, StaticPublisher &pub) {
+  Transforms updated;
+  try {
+    load_transforms(options, updated);
+  } catch (const ParseError &e) {
+    ROS_ERROR_STREAM("failed to reload " << options.filename << ": " << e.what()
+                     << ", keeping previous transforms");
+    return;
+  }
+
+  std::map<std::string, const geometry_msgs::TransformStamped*> previous;
+  for (Transforms::const_iterator it = transforms.begin(), end = transforms.end(); it != end; ++it)
+    previous[it->child_frame_id] = &*it;
+
+  size_t changed = 0, added = 0;
+  const ros::Time now = ros::Time::now();
+  for (Transforms::iterator it = updated.begin(), end = updated.end(); it != end; ++it) {
+    std::map<std::string, const geometry_msgs::TransformStamped*>::iterator prev =
+        previous.find(it->child_frame_id);
+    if (prev == previous.end()) {
+      ++added;
+      it->header.stamp = now;
+    } else {
+      if (same_transform(*it, *prev->second))
+        it->header.stamp = prev->second->header.stamp; // keep unchanged entries as they are
+      else {
+        ++changed;
+        it->header.stamp = now;
+      }
+      previous.erase(prev);
+    }
+  }
+  const size_t removed = previous.size();
+  if (changed == 0 && added == 0 && removed == 0) return;
+
+  // latched topic: the new message needs to comprise the whole set
+  // (in chunked mode, only chunks with changes are sent)
+  transforms.swap(updated);
+  pub.publish(transforms);
+  ROS_INFO("reloaded %s: %zu changed, %zu added, %zu removed transforms",
+           options.filename.c_str(), changed, added, removed);
+}
+
+/// watch options.filename for modifications until shutdown
+static void watch(const Options &options, Transforms &transforms, StaticPublisher &pub) {
+  // watch the directory to also catch atomic replacement via rename()
+  const std::string &filename = options.filename;
+  const size_t slash = filename.rfind('/');
+  const std::string dir = slash == std::string::npos ? "." : filename.substr(0, std::max<size_t>(slash, 1));
+  const std::string base = slash == std::string::npos ? filename : filename.substr(slash + 1);
+
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    ROS_WARN("failed to watch %s: %s", filename.c_str(), strerror(errno));
+    if (fd >= 0) close(fd);
+    ros::spin();
+    return;
+  }
+
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  struct pollfd pfd = { fd, POLLIN, 0 };
+  while (ros::ok()) {
+    if (poll(&pfd, 1, 100) <= 0) continue; // timeout allows to check ros::ok()
+
+    bool modified = false;
+    ssize_t len;
+    while ((len = read(fd, buffer, sizeof(buffer))) > 0) {
+      for (const char *p = buffer; p < buffer + len; ) {
+        const struct inotify_event *event = reinterpret_cast<const struct inotify_event*>(p);
+        if (event->len && base == event->name) modified = true;
+        p += sizeof(struct inotify_event) + event->len;
+      }
+    }
+    if (modified) reload(options, transforms, pub);
+  }
+  close(fd);
+}
+
 int main(int argc, char ** argv)
 {
   // Initialize ROS
   ros::init(argc, argv, "static_transform_publisher", ros::init_options::AnonymousName);
 
-  geometry_msgs::TransformStamped msg;
-  parse_arguments(argc, argv, msg);
+  Options options;
+  Transforms transforms;
+  parse_arguments(argc, argv, options, transforms);
 
-  if (msg.header.frame_id.empty() || msg.child_frame_id.empty())
-  {
-    ROS_FATAL("target or source frame is empty");
-    exit(1);
-  }
-  if (msg.header.frame_id == msg.child_frame_id)
-  {
-    ROS_FATAL("target and source frame are the same (%s, %s) this cannot work",
-              msg.child_frame_id.c_str(), msg.header.frame_id.c_str());
-    exit(1);
-  }
+  // publish all transforms with a single (latched) message, or in chunks
+  StaticPublisher pub(options.chunks);
+  const ros::Time now = ros::Time::now();
+  for (Transforms::iterator it = transforms.begin(), end = transforms.end(); it != end; ++it)
+    it->header.stamp = now;
+  pub.publish(transforms);
 
-  tf2_ros::StaticTransformBroadcaster broadcaster;
-  broadcaster.sendTransform(msg);
+  if (transforms.size() == 1)
+    ROS_INFO("Spinning until killed, publishing %s to %s",
+             transforms.front().header.frame_id.c_str(), transforms.front().child_frame_id.c_str());
+  else
+    ROS_INFO("Spinning until killed, publishing %zu transforms", transforms.size());
 
-  ROS_INFO("Spinning until killed, publishing %s to %s",
-           msg.header.frame_id.c_str(), msg.child_frame_id.c_str());
-  ros::spin();
+  if (options.filename.empty())
+    ros::spin();
+  else
+    watch(options, transforms, pub);
 
   return 0;
 }
@@ -32,29 +32,38 @@
 #include <ros/ros.h>
 #include <QApplication>
 #include <QVBoxLayout>
+#include <QScrollArea>
+#include <QFrame>
+#include <algorithm>
 
 #include "FramesWidget.h"
 #include "TransformWidget.h"
 #include "TransformBroadcaster.h"
 
-int main(int argc, char *argv[])
+/** Add a row of frame + transform editors, publishing via its own TransformBroadcaster.
+ *
+ *  All broadcasters share the process-wide StaticTransformRegistry: editing a row only
+ *  updates this row's entry, and changes of all rows are coalesced into a single /tf_static message.
+ */
+static void addRow(QVBoxLayout *layout, QWidget *owner,
+                   const QString &parent_frame, const QString &child_frame,
+                   double max_rate, int throttle_interval)
 {
-  ros::init(argc, argv, "static_transform_publisher_gui",
-            ros::init_options::AnonymousName ||
-            ros::init_options::NoSigintHandler);
-  QApplication app(argc, argv);
-
-  QWidget *main = new QWidget();
-  QVBoxLayout *l = new QVBoxLayout();
-
-  FramesWidget *frames = new FramesWidget();
+  FramesWidget *frames = new FramesWidget(parent_frame, child_frame);
   TransformWidget *tf_widget = new TransformWidget();
-  l->addWidget(frames);
-  l->addWidget(tf_widget);
-  main->setLayout(l);
+  tf_widget->setThrottleInterval(throttle_interval);
+  if (layout->count() > 0) {
+    QFrame *line = new QFrame();
+    line->setFrameShape(QFrame::HLine);
+    line->setFrameShadow(QFrame::Sunken);
+    layout->addWidget(line);
+  }
+  layout->addWidget(frames);
+  layout->addWidget(tf_widget);
 
   TransformBroadcaster *tf_pub = new TransformBroadcaster(frames->parentFrame(),
-                                                          frames->childFrame(), main);
+                                                          frames->childFrame(), owner);
+  tf_pub->setMaxRate(max_rate);
   QObject::connect(frames, SIGNAL(parentFrameChanged(QString)),
                    tf_pub, SLOT(setParentFrame(QString)));
   QObject::connect(frames, SIGNAL(childFrameChanged(QString)),
@@ -64,10 +73,57 @@ int main(int argc, char *argv[])
                    tf_pub, SLOT(setPosition(Eigen::Vector3d)));
   QObject::connect(tf_widget, SIGNAL(quaternionChanged(Eigen::Quaterniond)),
                    tf_pub, SLOT(setQuaternion(Eigen::Quaterniond)));
+}
+
+int main(int argc, char *argv[])
+{
+  ros::init(argc, argv, "static_transform_publisher_gui",
+            ros::init_options::AnonymousName ||
+            ros::init_options::NoSigintHandler);
+  QApplication app(argc, argv);
+
+  ros::NodeHandle nh("~");
+  double max_rate = 0; // default: publish once per event-loop iteration
+  nh.getParam("max_rate", max_rate);
+  int throttle_interval = 0; // default: forward every spin box edit
+  nh.getParam("throttle_interval", throttle_interval);
+  // multi-row mode: one row per child frame listed in ~frames, w.r.t. ~parent_frame
+  std::vector<std::string> child_frames;
+  nh.getParam("frames", child_frames);
+  std::string parent_frame;
+  nh.getParam("parent_frame", parent_frame);
+  if (child_frames.empty()) child_frames.push_back(""); // single row
+  // optionally publish /tf_static in content-hashed chunks
+  int chunks = 0;
+  nh.getParam("chunks", chunks);
+  StaticTransformRegistry::Ptr registry = StaticTransformRegistry::instance();
+  registry->setChunks(std::max(0, chunks));
+
+  QWidget *main = new QWidget();
+  QVBoxLayout *l = new QVBoxLayout();
+  for (size_t i = 0; i < child_frames.size(); ++i)
+    addRow(l, main, QString::fromStdString(parent_frame),
+           QString::fromStdString(child_frames[i]), max_rate, throttle_interval);
+
+  QWidget *window = main;
+  if (child_frames.size() > 1) { // scrollable list of rows
+    l->addStretch();
+    main->setLayout(l);
+    QScrollArea *scroll = new QScrollArea();
+    scroll->setWidgetResizable(true);
+    scroll->setWidget(main);
+    window = scroll;
+  } else
+    main->setLayout(l);
+
+  window->setWindowTitle("static transform publisher");
+  window->show();
 
-  main->setWindowTitle("static transform publisher");
-  main->show();
+  // process ROS callbacks in background, keeping the GUI thread responsive
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
   int ret = app.exec();
-  delete main;
+  spinner.stop();
+  delete window;
   return ret;
 }
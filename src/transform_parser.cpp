@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2008, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "transform_parser.h"
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+const size_t NUM_ARGS = 3 + 2; // position + frames
+
+// precomputed quaternion modes
+const struct {
+  const char *name;
+  unsigned char order[4];
+} QUATERNION_MODES[] = {
+  { "xyzw", {0, 1, 2, 3} },
+  { "wxyz", {3, 0, 1, 2} },
+};
+
+std::string quoted(const Token &token)
+{
+  return "'" + token.str() + "'";
+}
+
+/// default modes for 4 and 3 rotational arguments
+const RotationMode &defaultMode(bool quaternion)
+{
+  static const RotationMode XYZW = parse_mode("xyzw");
+  static const RotationMode ZYX = parse_mode("zyx");
+  return quaternion ? XYZW : ZYX;
+}
+
+}
+
+RotationMode parse_mode(const char *spec)
+{
+  RotationMode mode;
+  if (!*spec) return mode;
+  for (size_t i = 0; i < sizeof(QUATERNION_MODES) / sizeof(QUATERNION_MODES[0]); ++i) {
+    if (std::strcmp(spec, QUATERNION_MODES[i].name) == 0) {
+      mode.type = RotationMode::QUATERNION;
+      std::memcpy(mode.order, QUATERNION_MODES[i].order, sizeof(mode.order));
+      return mode;
+    }
+  }
+
+  // Euler axes
+  std::string error;
+  if (!mode.convention.parse(spec, &error))
+    throw ParseError("invalid mode specification for Euler angles: " + error);
+  mode.type = RotationMode::EULER;
+  return mode;
+}
+
+double parse_double(const Token &token)
+{
+  // strtod requires a null-terminated string
+  char buffer[64];
+  const size_t size = token.size();
+  if (size > 0 && size < sizeof(buffer)) {
+    std::memcpy(buffer, token.begin, size);
+    buffer[size] = '\0';
+    char *end;
+    const double value = std::strtod(buffer, &end);
+    if (end == buffer + size)
+      return value;
+  }
+  throw ParseError("failed to parse numerical value: " + quoted(token));
+}
+
+const RotationMode &parse_transform(const Tuple &args, const RotationMode &requested_mode,
+                                    geometry_msgs::TransformStamped &msg, double *euler)
+{
+  const RotationMode *mode = &requested_mode;
+  if (mode->type == RotationMode::AUTO) {
+    if (args.size() == NUM_ARGS + 4)
+      mode = &defaultMode(true); // 4 rotational args trigger quaternion mode
+    else if (args.size() == NUM_ARGS + 3)
+      mode = &defaultMode(false);
+    else
+      throw ParseError("invalid number of positional arguments");
+  }
+  const size_t expected = NUM_ARGS + (mode->type == RotationMode::QUATERNION ? 4 : 3);
+  if (args.size() != expected)
+    throw ParseError(std::string(mode->type == RotationMode::QUATERNION ?
+                                   "quaternion mode requires " : "Euler angles require ") +
+                     std::to_string(expected) + " positional arguments");
+
+  // consume position arguments
+  Tuple::const_iterator arg = args.begin();
+  msg.transform.translation.x = parse_double(*arg++);
+  msg.transform.translation.y = parse_double(*arg++);
+  msg.transform.translation.z = parse_double(*arg++);
+
+  // consume orientation arguments
+  Eigen::Quaterniond q;
+  if (mode->type == RotationMode::QUATERNION) {
+    for (size_t i = 0; i < 4; ++i)
+      q.coeffs()[mode->order[i]] = parse_double(*arg++);
+    q.normalize();
+  } else {
+    double e[3];
+    for (size_t i = 0; i < 3; ++i)
+      e[i] = parse_double(*arg++);
+    if (euler) std::copy(e, e + 3, euler); // conversion is deferred to the caller
+    else q = mode->convention.quaternion(e[0], e[1], e[2]);
+  }
+  // assign quaternion
+  if (mode->type == RotationMode::QUATERNION || !euler) {
+    msg.transform.rotation.x = q.x();
+    msg.transform.rotation.y = q.y();
+    msg.transform.rotation.z = q.z();
+    msg.transform.rotation.w = q.w();
+  }
+
+  // consume link arguments
+  msg.header.frame_id.assign(arg->begin, arg->end); ++arg;
+  msg.child_frame_id.assign(arg->begin, arg->end); ++arg;
+
+  if (msg.header.frame_id.empty() || msg.child_frame_id.empty())
+    throw ParseError("target or source frame is empty");
+  if (msg.header.frame_id == msg.child_frame_id)
+    throw ParseError("target and source frame are the same (" +
+                     msg.child_frame_id + ", " + msg.header.frame_id + ") this cannot work");
+  return *mode;
+}
+
+void split_tuples(const Tuple &args, std::vector<Tuple> &tuples)
+{
+  tuples.push_back(Tuple());
+  for (Tuple::const_iterator it = args.begin(), end = args.end(); it != end; ++it) {
+    if (*it == ",") tuples.push_back(Tuple());
+    else tuples.back().push_back(*it);
+  }
+}
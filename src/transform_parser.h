@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2008, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <geometry_msgs/TransformStamped.h>
+#include <stdexcept>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "common/EulerConversion.h"
+
+/// error while parsing transform arguments
+class ParseError : public std::runtime_error
+{
+public:
+  explicit ParseError(const std::string &msg) : std::runtime_error(msg) {}
+};
+
+/// non-owning reference to a token within argv or a memory-mapped file
+struct Token
+{
+  Token() : begin(NULL), end(NULL) {}
+  Token(const char *b, const char *e) : begin(b), end(e) {}
+  explicit Token(const char *s) : begin(s), end(s + std::strlen(s)) {}
+
+  size_t size() const { return end - begin; }
+  std::string str() const { return std::string(begin, end); }
+  bool operator==(const char *s) const {
+    return std::strncmp(begin, s, size()) == 0 && s[size()] == '\0';
+  }
+
+  const char *begin;
+  const char *end;
+};
+typedef std::vector<Token> Tuple;
+
+/// rotation specification (--mode), resolved once for all tuples
+struct RotationMode
+{
+  enum Type { AUTO, QUATERNION, EULER };
+  RotationMode() : type(AUTO) {}
+
+  Type type;
+  unsigned char order[4]; ///< QUATERNION: index of each argument into Eigen's xyzw coefficients
+  euler::Convention convention; ///< EULER: axes convention
+};
+
+/// resolve a --mode specification: empty, xyzw, wxyz, or Euler axes (e.g. zyx, sxyz, rpy)
+RotationMode parse_mode(const char *spec);
+
+/// parse a double from the full token
+double parse_double(const Token &token);
+
+/** parse a single tuple x y z <rotation> parent_frame_id child_frame_id into msg
+ *  @param euler if given, Euler angles are stored here instead of being converted into
+ *               msg's rotation, e.g. for subsequent bulk conversion
+ *  @return resolved rotation mode of the tuple
+ */
+const RotationMode &parse_transform(const Tuple &args, const RotationMode &mode,
+                                    geometry_msgs::TransformStamped &msg,
+                                    double *euler = NULL);
+
+/// split positional arguments into tuples separated by ","
+void split_tuples(const Tuple &args, std::vector<Tuple> &tuples);